@@ -0,0 +1,412 @@
+#include "AlgorithmBoustrophedon.h"
+#include "AlgorithmRegistration.h"
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace {
+// Lanes run north/south; east and west only step to the next lane
+constexpr Direction kSweepOrder[4] = {Direction::North, Direction::South, Direction::East, Direction::West};
+// Time the tour planner may take in one step
+constexpr auto kPlanningSlice = std::chrono::microseconds(200);
+}
+
+AlgorithmBoustrophedon::AlgorithmBoustrophedon()
+    : dock_search_(explorer_), target_search_(explorer_), tour_(explorer_) {
+}
+
+void AlgorithmBoustrophedon::setSensorSnapshot(const SensorSnapshot &snapshot, std::size_t maxBattery) {
+    sensors_.setSnapshot(snapshot, maxBattery);
+    startAt(snapshot.position);
+}
+
+void AlgorithmBoustrophedon::startAt(const Position& dock) {
+    docking_station_ = dock;
+    explorer_.setDockingStation(docking_station_);
+    dock_search_.setGoal(docking_station_);
+}
+
+void AlgorithmBoustrophedon::reset() {
+    max_steps_ = 0;
+    steps_counter_ = 0;
+    sensors_ = SensorFeed();
+    snapshot_ = nullptr;
+    max_battery_ = 0;
+    docking_station_ = {0, 0};
+    explorer_.reset();
+    dock_search_.clearGoal();
+    target_search_.clearGoal();
+    curr_state_ = State::EXPLORE;
+    resume_pos_ = {-20, -20};
+    battery_drift_ = 0;
+    touring_ = false;
+    tour_.clear();
+    trip_.clear();
+    trip_stop_ = 0;
+}
+
+// The map lives in resource, which the worker keeps for the next run of this instance; reset() clears it in place
+void AlgorithmBoustrophedon::setMemoryResource(std::pmr::memory_resource *resource) {
+    explorer_.reset(resource);
+}
+
+void AlgorithmBoustrophedon::setMaxSteps(std::size_t maxSteps) {
+    max_steps_ = maxSteps;
+}
+
+void AlgorithmBoustrophedon::setWallsSensor(const WallsSensor& wallsSensor) {
+    sensors_.setWallsSensor(wallsSensor);
+}
+
+void AlgorithmBoustrophedon::setDirtSensor(const DirtSensor& dirtSensor) {
+    sensors_.setDirtSensor(dirtSensor);
+}
+
+// Without a snapshot, which the simulator passes after the setters, the position is followed from the docking
+// station, see SensorFeed
+void AlgorithmBoustrophedon::setBatteryMeter(const BatteryMeter& batteryMeter) {
+    sensors_.setBatteryMeter(batteryMeter);
+    if (!sensors_.hasSnapshot()) {
+        startAt(SensorFeed::kTrackedDock);
+    }
+}
+
+int AlgorithmBoustrophedon::getMinDistanceOfNeighbors(const Position& curr_pos) {
+    if (curr_pos == docking_station_) return 0;
+    int minDistance = -1;
+    for (const auto& dir : {Direction::North, Direction::East, Direction::South, Direction::West}) {
+        Position neighbor = PositionUtils::movePosition(curr_pos, dir);
+        if (explorer_.isKnownFloor(neighbor)) {
+            int neighborDistance = explorer_.getDistance(neighbor);
+            if (neighborDistance >= 0 && (minDistance < 0 || neighborDistance + 1 < minDistance)) {
+                minDistance = neighborDistance + 1;
+            }
+        }
+    }
+    return minDistance;
+}
+
+void AlgorithmBoustrophedon::updateExplorerInfo(const Position& curr_pos) {
+    const SensorSnapshot& sensed = *snapshot_;
+    if (!explorer_.isKnownFloor(curr_pos)) {
+        explorer_.setDirtLevel(curr_pos, sensed.dirt);
+        explorer_.setDistance(curr_pos, getMinDistanceOfNeighbors(curr_pos));
+        explorer_.removeFromUnexplored(curr_pos);
+        for (const auto& dir : {Direction::North, Direction::East, Direction::South, Direction::West}) {
+            explorer_.updateAdjacentArea(dir, curr_pos, sensed.isWall(dir));
+        }
+    } else {
+        explorer_.setDirtLevel(curr_pos, sensed.dirt);
+    }
+}
+
+bool AlgorithmBoustrophedon::hasUnvisitedNeighbor(const Position& pos) const {
+    for (Direction dir : kSweepOrder) {
+        Position neighbor = PositionUtils::movePosition(pos, dir);
+        if (explorer_.isPassable(neighbor) && !explorer_.isKnownFloor(neighbor)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// An unexplored area, or explored floor that is dirty or next to an unexplored area
+bool AlgorithmBoustrophedon::isWorkLeft(const Position& pos) {
+    if (explorer_.isAreaUnexplored(pos)) {
+        return true;
+    }
+    return explorer_.isKnownFloor(pos) && (explorer_.getDirtLevel(pos) > 0 || hasUnvisitedNeighbor(pos));
+}
+
+// Steps needed to reach target, do one unit of work there (clean once, or step to an unvisited neighbour and back)
+// and get back to the docking station, or INT_MAX if the way back is not known
+int AlgorithmBoustrophedon::getTargetCost(const Position& target, int distance) {
+    if (explorer_.isAreaUnexplored(target)) {
+        int back = explorer_.getFrontierDockDistance(target);
+        return back < 0 ? INT_MAX : distance + back;
+    }
+    int back = explorer_.getDistance(target);
+    if (back < 0) {
+        return INT_MAX;
+    }
+    return distance + back + (explorer_.getDirtLevel(target) > 0 ? 1 : 2);
+}
+
+// Plan the way to where the next sweep starts: the interrupted sweep if there is one, otherwise the closer of
+// the closest dirt and the closest unexplored area. Only targets that fit in budget are taken.
+bool AlgorithmBoustrophedon::chooseNextSweep(const Position& curr_pos, int budget) {
+    std::vector<Position> candidates;
+    if (resume_pos_.r != -20) {
+        if (isWorkLeft(resume_pos_)) {
+            candidates.push_back(resume_pos_);
+        } else {
+            resume_pos_ = {-20, -20};
+        }
+    }
+    int dirtDistance, unexploredDistance;
+    Position dirt = explorer_.getClosestDirtyArea(curr_pos, dirtDistance);
+    Position unexplored = explorer_.getNearestFrontier(INT_MAX);
+    unexploredDistance = unexplored.r == -20 ? -1 : explorer_.manhattanDistance(curr_pos, unexplored);
+    if (unexploredDistance >= 0 && (dirtDistance < 0 || unexploredDistance < dirtDistance)) {
+        std::swap(dirt, unexplored);
+        std::swap(dirtDistance, unexploredDistance);
+    }
+    if (dirtDistance >= 0) {
+        candidates.push_back(dirt);
+    }
+    if (unexploredDistance >= 0) {
+        candidates.push_back(unexplored);
+    }
+
+    for (const auto& target : candidates) {
+        if (!target_search_.hasGoal() || target_search_.getGoal() != target) {
+            target_search_.setGoal(target);
+        }
+        int path = target_search_.update(curr_pos);
+        if (path >= 0 && getTargetCost(target, path) <= budget) {
+            return true;
+        }
+    }
+    target_search_.clearGoal();
+    return false;
+}
+
+// Start planning trips that clean all the known dirt, each costing at most capacity steps
+void AlgorithmBoustrophedon::planTour(int capacity) {
+    std::vector<TourStop> stops;
+    for (const auto& [pos, area] : explorer_.mapped_areas_) {
+        if (area.first > 0) {
+            stops.push_back({pos, area.first});
+        }
+    }
+    tour_.reset(docking_station_, stops, capacity);
+    tour_.advance(TourPlanner::Clock::now() + kPlanningSlice);
+}
+
+// The planned trip that cleans the most dirt per step among those that fit in fullBudget
+bool AlgorithmBoustrophedon::chooseTrip(int fullBudget, std::size_t& trip) {
+    bool found = false;
+    for (std::size_t candidate = 0; candidate < tour_.getTripCount(); ++candidate) {
+        int cost = tour_.getTripCost(candidate);
+        if (cost > fullBudget) {
+            continue;
+        }
+        if (!found || tour_.getTripDemand(candidate) * tour_.getTripCost(trip) >
+                      tour_.getTripDemand(trip) * cost) {
+            trip = candidate;
+            found = true;
+        }
+    }
+    return found;
+}
+
+// Running out of steps scores as if nothing was cleaned, so keep two steps to be docked and return Finish
+std::size_t AlgorithmBoustrophedon::getRemainingSteps() const {
+    return max_steps_ > steps_counter_ + 2 ? max_steps_ - steps_counter_ - 2 : 0;
+}
+
+Step AlgorithmBoustrophedon::move(Direction dir, const Position& curr_pos) {
+    steps_counter_++;
+    if (PositionUtils::movePosition(curr_pos, dir) == docking_station_) {
+        battery_drift_++;
+    }
+    return Step(dir);
+}
+
+Step AlgorithmBoustrophedon::nextStep() {
+    snapshot_ = sensors_.read();
+    if (!snapshot_) {
+        return Step::Finish; // neither a snapshot nor the sensors were given
+    }
+    max_battery_ = sensors_.getMaxBattery();
+    return sensors_.taken(decideStep());
+}
+
+Step AlgorithmBoustrophedon::decideStep() {
+    Position curr_pos = snapshot_->position;
+    updateExplorerInfo(curr_pos);
+    int dock_distance = dock_search_.update(curr_pos);
+    if (dock_distance >= 0) {
+        explorer_.setDistance(curr_pos, dock_distance);
+    }
+    int dirt = snapshot_->dirt;
+    std::size_t remaining = getRemainingSteps();
+    std::size_t battery = snapshot_->battery;
+    int budget = static_cast<int>(std::min(battery, remaining)) - battery_drift_;
+
+    // A step passes through a few states at most; the bound only guards against a transition cycle
+    for (int transition = 0; transition < 8; ++transition) {
+        switch (curr_state_) {
+            case State::CLEANING: {
+                if (dirt > 0 && budget >= dock_distance + 1) {
+                    steps_counter_++;
+                    return Step::Stay;
+                }
+                if (dirt > 0) {
+                    resume_pos_ = curr_pos;
+                    curr_state_ = State::TO_DOCK;
+                } else {
+                    curr_state_ = State::EXPLORE;
+                }
+                break;
+            }
+
+            case State::EXPLORE: {
+                if (dirt > 0) {
+                    curr_state_ = State::CLEANING;
+                    break;
+                }
+                auto next = std::find_if(std::begin(kSweepOrder), std::end(kSweepOrder), [&](Direction dir) {
+                    return !snapshot_->isWall(dir) &&
+                           !explorer_.isKnownFloor(PositionUtils::movePosition(curr_pos, dir));
+                });
+                if (next == std::end(kSweepOrder)) {
+                    // End of this sweep, plan the way to the next one
+                    target_search_.clearGoal();
+                    curr_state_ = State::TO_POS;
+                    break;
+                }
+                if (budget >= dock_distance + 2) {
+                    return move(*next, curr_pos);
+                }
+                resume_pos_ = curr_pos;
+                curr_state_ = State::TO_DOCK;
+                break;
+            }
+
+            case State::TO_POS: {
+                if (target_search_.hasGoal() && target_search_.getGoal() == curr_pos) {
+                    target_search_.clearGoal();
+                    curr_state_ = State::EXPLORE;
+                    break;
+                }
+                if (target_search_.hasGoal() && isWorkLeft(target_search_.getGoal())) {
+                    int path = target_search_.update(curr_pos);
+                    if (path < 0 || getTargetCost(target_search_.getGoal(), path) > budget) {
+                        target_search_.clearGoal();
+                    }
+                } else {
+                    target_search_.clearGoal();
+                }
+                Direction dir;
+                if ((!target_search_.hasGoal() && !chooseNextSweep(curr_pos, budget)) ||
+                    !target_search_.nextMove(dir)) {
+                    curr_state_ = State::TO_DOCK;
+                    break;
+                }
+                if (target_search_.getGoal() == curr_pos) {
+                    break;
+                }
+                return move(dir, curr_pos);
+            }
+
+            case State::TO_DOCK: {
+                if (curr_pos != docking_station_) {
+                    Direction dir;
+                    if (dock_search_.nextMove(dir)) {
+                        return move(dir, curr_pos);
+                    }
+                    steps_counter_++;
+                    return Step::Stay;
+                }
+                if (!explorer_.hasMoreDirtyAreas() && explorer_.areAllAreasExplored()) {
+                    return Step::Finish;
+                }
+                std::size_t fullBudget = std::min(max_battery_, remaining);
+                // Only dirt is left once no unexplored area can be reached and returned from on a full battery
+                if (touring_ || explorer_.getNearestFrontier(static_cast<int>(fullBudget) / 2).r == -20) {
+                    touring_ = true;
+                    planTour(static_cast<int>(fullBudget));
+                    curr_state_ = State::CHARGING;
+                    break;
+                }
+                // Charge only if a full battery makes the next sweep reachable
+                if (!chooseNextSweep(curr_pos, static_cast<int>(fullBudget))) {
+                    return Step::Finish;
+                }
+                curr_state_ = State::CHARGING;
+                break;
+            }
+
+            case State::CHARGING: {
+                if (touring_) {
+                    // Charge only as much as the next trip needs. Planning gets one slice per step, charged or
+                    // not, so the robot stays at the docking station until the trips are ready.
+                    if (!tour_.isImproved()) {
+                        tour_.advance(TourPlanner::Clock::now() + kPlanningSlice);
+                    }
+                    int fullBudget = static_cast<int>(std::min(max_battery_, remaining));
+                    std::size_t trip = 0;
+                    if (tour_.isReady() && !chooseTrip(fullBudget, trip)) {
+                        if (tour_.getCapacity() <= fullBudget) {
+                            return Step::Finish;
+                        }
+                        // The steps left no longer allow the trips planned, plan shorter ones
+                        planTour(fullBudget);
+                        break;
+                    }
+                    if (!tour_.isReady() || battery_drift_ > 0 || budget < tour_.getTripCost(trip)) {
+                        battery_drift_ = 0;
+                        steps_counter_++;
+                        return Step::Stay;
+                    }
+                    trip_ = tour_.getTrip(trip);
+                    trip_stop_ = 0;
+                    target_search_.clearGoal();
+                    curr_state_ = State::TOUR;
+                    break;
+                }
+                if (battery_drift_ > 0 || (battery < max_battery_ && battery < remaining)) {
+                    battery_drift_ = 0;
+                    steps_counter_++;
+                    return Step::Stay;
+                }
+                curr_state_ = State::TO_POS;
+                break;
+            }
+
+            case State::TOUR: {
+                // Skip stops that got clean on the way, e.g. while cleaning an earlier stop partially
+                while (trip_stop_ < trip_.size() && curr_pos != trip_[trip_stop_].pos &&
+                       explorer_.getDirtLevel(trip_[trip_stop_].pos) <= 0) {
+                    trip_stop_++;
+                }
+                if (trip_stop_ == trip_.size()) {
+                    target_search_.clearGoal();
+                    curr_state_ = State::TO_DOCK;
+                    break;
+                }
+                TourStop& stop = trip_[trip_stop_];
+                if (curr_pos == stop.pos) {
+                    if (dirt > 0 && stop.demand > 0 && budget >= dock_distance + 1) {
+                        stop.demand--;
+                        steps_counter_++;
+                        return Step::Stay;
+                    }
+                    trip_stop_++;
+                    break;
+                }
+                if (!target_search_.hasGoal() || target_search_.getGoal() != stop.pos) {
+                    target_search_.setGoal(stop.pos);
+                }
+                int path = target_search_.update(curr_pos);
+                Direction dir;
+                if (path < 0 || getTargetCost(stop.pos, path) > budget || !target_search_.nextMove(dir)) {
+                    target_search_.clearGoal();
+                    curr_state_ = State::TO_DOCK;
+                    break;
+                }
+                return move(dir, curr_pos);
+            }
+
+            case State::FINISH:
+                return Step::Finish;
+        }
+    }
+    steps_counter_++;
+    return Step::Stay;
+}
+
+extern "C" {
+REGISTER_ALGORITHM(AlgorithmBoustrophedon);
+}
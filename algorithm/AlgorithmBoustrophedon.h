@@ -0,0 +1,72 @@
+#ifndef VACUUM_FINAL_ALGORITHMBOUSTROPHEDON_H
+#define VACUUM_FINAL_ALGORITHMBOUSTROPHEDON_H
+
+#include "../simulator/Explorer.h"
+#include "../simulator/DStarLite.h"
+#include "../simulator/TourPlanner.h"
+#include "../common/AbstractAlgorithm.h"
+#include "../common/ResettableAlgorithm.h"
+#include "../common/AllocatorAwareAlgorithm.h"
+#include "../common/SnapshotAlgorithm.h"
+#include "../common/SensorFeed.h"
+#include "../common/states.h"
+
+// Boustrophedon coverage: the robot sweeps the free space in lawnmower order (north/south lanes, stepping east
+// or west between them), cleaning each dirty cell as it passes. A sweep ends at a cell with no unvisited
+// neighbour; only then a path is planned, to the start of the next sweep (the closest unvisited or dirty area).
+// Trips are bounded by the battery: the robot heads home when one more step would leave too little to return,
+// and resumes the interrupted sweep after charging.
+// Once no unexplored area is left within reach, the dirt left is cleaned in trips planned from the docking
+// station, see TourPlanner. Planning is spread over the charging steps, with a time budget per step.
+class AlgorithmBoustrophedon : public AbstractAlgorithm, public ResettableAlgorithm, public AllocatorAwareAlgorithm,
+                               public SnapshotAlgorithm {
+public:
+    AlgorithmBoustrophedon();
+    virtual ~AlgorithmBoustrophedon() = default;
+    void setMaxSteps(std::size_t maxSteps) override;
+    void setWallsSensor(const WallsSensor &) override;
+    void setDirtSensor(const DirtSensor &) override;
+    void setBatteryMeter(const BatteryMeter &) override;
+    Step nextStep() override;
+    void reset() override;
+    void setMemoryResource(std::pmr::memory_resource *resource) override;
+    void setSensorSnapshot(const SensorSnapshot &snapshot, std::size_t maxBattery) override;
+
+private:
+    void startAt(const Position& dock);
+    Step decideStep();
+
+    std::size_t max_steps_ = 0;
+    std::size_t steps_counter_ = 0;
+    SensorFeed sensors_;
+    const SensorSnapshot* snapshot_ = nullptr; // this step's readings, from sensors_
+    std::size_t max_battery_ = 0;
+    Position docking_station_ = {0, 0};
+
+    Explorer explorer_;
+    DStarLite dock_search_;   // goal is the docking station
+    DStarLite target_search_; // goal is the start of the next sweep
+
+    State curr_state_ = State::EXPLORE;
+    Position resume_pos_ = {-20, -20}; // where a sweep was interrupted to go charging
+    // Steps the simulator's Vacuum pays for but the battery meter does not, see AlgorithmDStarLite
+    int battery_drift_ = 0;
+
+    bool touring_ = false; // exploring is done, the rest of the run follows planned trips
+    TourPlanner tour_;
+    std::vector<TourStop> trip_; // stops of the trip being followed
+    std::size_t trip_stop_ = 0;
+
+    void updateExplorerInfo(const Position& curr_pos);
+    int getMinDistanceOfNeighbors(const Position& curr_pos);
+    bool hasUnvisitedNeighbor(const Position& pos) const;
+    bool isWorkLeft(const Position& pos);
+    int getTargetCost(const Position& target, int distance);
+    bool chooseNextSweep(const Position& curr_pos, int budget);
+    void planTour(int capacity);
+    bool chooseTrip(int fullBudget, std::size_t& trip);
+    std::size_t getRemainingSteps() const;
+    Step move(Direction dir, const Position& curr_pos);
+};
+
+#endif //VACUUM_FINAL_ALGORITHMBOUSTROPHEDON_H
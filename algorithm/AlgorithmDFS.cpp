@@ -10,13 +10,39 @@
 #include "AlgorithmRegistration.h"
 
 AlgorithmDFS::AlgorithmDFS() :
-        sensors_(nullptr), max_steps_(0), prev_state(State::EXPLORE), curr_state(State::EXPLORE) {
+        snapshot_(nullptr), max_steps_(0), prev_state(State::EXPLORE), curr_state(State::EXPLORE) {
     explorer_ = Explorer();
 }
 
-void AlgorithmDFS::setSensors(SensorImpl &sensors) {
-    sensors_ = &sensors;
-    docking_station = {sensors_->getCurrentPosition().first, sensors_->getCurrentPosition().second};
+void AlgorithmDFS::setSensorSnapshot(const SensorSnapshot &snapshot, std::size_t maxBattery) {
+    sensors_.setSnapshot(snapshot, maxBattery);
+    startAt(snapshot.position);
+}
+
+void AlgorithmDFS::startAt(const Position& dock) {
+    docking_station = dock;
+    explorer_.setDockingStation(docking_station);
+}
+
+void AlgorithmDFS::reset() {
+    max_steps_ = 0;
+    steps_counter = 0;
+    sensors_ = SensorFeed();
+    snapshot_ = nullptr;
+    max_battery_ = 0;
+    explorer_.reset();
+    dock_plan_ = PathPlan();
+    pos_plan_ = PathPlan();
+    prev_state = State::EXPLORE;
+    curr_state = State::EXPLORE;
+    docking_station = {0, 0};
+    last_dirty_pos_ = {-20, -20};
+    queries_ = StepQueries();
+}
+
+// The map lives in resource, which the worker keeps for the next run of this instance; reset() clears it in place
+void AlgorithmDFS::setMemoryResource(std::pmr::memory_resource *resource) {
+    explorer_.reset(resource);
 }
 
 void AlgorithmDFS::setMaxSteps(std::size_t maxSteps) {
@@ -24,15 +50,20 @@ void AlgorithmDFS::setMaxSteps(std::size_t maxSteps) {
 }
 
 void AlgorithmDFS::setWallsSensor(const WallsSensor& wallsSensor) {
-    setSensors(const_cast<SensorImpl&>(dynamic_cast<const SensorImpl&>(wallsSensor)));
+    sensors_.setWallsSensor(wallsSensor);
 }
 
 void AlgorithmDFS::setDirtSensor(const DirtSensor& dirtSensor) {
-    setSensors(const_cast<SensorImpl&>(dynamic_cast<const SensorImpl&>(dirtSensor)));
+    sensors_.setDirtSensor(dirtSensor);
 }
 
+// Without a snapshot, which the simulator passes after the setters, the position is followed from the docking
+// station, see SensorFeed
 void AlgorithmDFS::setBatteryMeter(const BatteryMeter& batteryMeter) {
-    setSensors(const_cast<SensorImpl&>(dynamic_cast<const SensorImpl&>(batteryMeter)));
+    sensors_.setBatteryMeter(batteryMeter);
+    if (!sensors_.hasSnapshot()) {
+        startAt(SensorFeed::kTrackedDock);
+    }
 }
 
 bool AlgorithmDFS::StateChanged() const {
@@ -46,17 +77,14 @@ State AlgorithmDFS::getCurrentState() const {
 int AlgorithmDFS::getMinDistanceOfNeighbors(const Position& curr_pos) {
     if (curr_pos == docking_station) return 0;
     int minDistance = INT_MAX;
-    std::vector<std::pair<int, int>> neighbors = explorer_.getNeighbors({curr_pos.r, curr_pos.c});
-
-    for (const auto& neighborPair : neighbors) {
-        Position neighbor = {neighborPair.first, neighborPair.second};
+    explorer_.forEachNeighbor(curr_pos, [&](const Position& neighbor) {
         if (explorer_.explored(neighbor)) {
             int neighborDistance = explorer_.getDistance(neighbor);
             if (neighborDistance+1 < minDistance) {
                 minDistance = neighborDistance + 1;
             }
         }
-    }
+    });
 
     if (minDistance == INT_MAX) {
         // None of the neighbors are explored. Handle this case accordingly.
@@ -67,16 +95,16 @@ int AlgorithmDFS::getMinDistanceOfNeighbors(const Position& curr_pos) {
 
 void AlgorithmDFS::updateExplorerInfo(Position current_position_) {
     if (!explorer_.explored(current_position_)) {
-        explorer_.setDirtLevel(current_position_, sensors_->dirtLevel());
+        explorer_.setDirtLevel(current_position_, snapshot_->dirt);
         explorer_.setDistance(current_position_, getMinDistanceOfNeighbors(current_position_));
         explorer_.removeFromUnexplored(current_position_);
 
         // Update adjacent areas for newly explored positions
         for (const auto& dir : {Direction::North, Direction::East, Direction::South, Direction::West}) {
-            explorer_.updateAdjacentArea(dir, current_position_, sensors_->isWall(dir));
+            explorer_.updateAdjacentArea(dir, current_position_, snapshot_->isWall(dir));
         }
     } else {
-        explorer_.updateDirtAndClean(current_position_, sensors_->dirtLevel());
+        explorer_.updateDirtAndClean(current_position_, snapshot_->dirt);
     }
 }
 
@@ -103,146 +131,177 @@ std::string AlgorithmDFS::stateToString(State state) {
         default: return "?";
     }
 }
-Step AlgorithmDFS::nextStep() {
-    std::cout << "curr_state: " << stateToString(curr_state) << std::endl;
-    Position curr_pos = {sensors_->getCurrentPosition().first, sensors_->getCurrentPosition().second};
-    auto path = explorer_.getShortestPath_A(sensors_->getCurrentPosition(),
-                                            {docking_station.r, docking_station.c}, false);
-    if(path.size() >= (max_steps_ - steps_counter)){
-        curr_state = State::TO_DOCK;
+// Dock plan for this step; the explorer only replans when the kept plan can no longer be followed
+const PathPlan& AlgorithmDFS::planToDock(const Position& curr_pos) {
+    if (queries_.dock_plan_version != explorer_.getMapVersion()) {
+        explorer_.updatePlan(dock_plan_, {curr_pos.r, curr_pos.c}, {docking_station.r, docking_station.c}, false);
+        queries_.dock_plan_version = explorer_.getMapVersion();
     }
-    if(curr_pos==docking_station){
-        Position pos = explorer_.getClosestUnexploredArea(curr_pos);
-        path = explorer_.getShortestPath_A(sensors_->getCurrentPosition(), {pos.c,pos.r},false);
-        if((path.size()>= (max_steps_ - steps_counter))){return Step::Finish; }
+    return dock_plan_;
+}
 
+// DFS ranks unexplored areas by the paths its planner would take to them, as it always did, see
+// Explorer::SearchOrder::Position
+Position AlgorithmDFS::closestUnexploredArea(const Position& curr_pos, int& distance) {
+    if (queries_.closest_unexplored_version != explorer_.getMapVersion()) {
+        queries_.closest_unexplored = explorer_.getClosestUnexploredArea(curr_pos, queries_.closest_unexplored_distance,
+                                                                         Explorer::SearchOrder::Position);
+        queries_.closest_unexplored_version = explorer_.getMapVersion();
     }
-    Position possible_pos = curr_pos;
-    switch (curr_state) {
-        case State::EXPLORE: {
-            updateExplorerInfo(curr_pos);
-            if (sensors_->dirtLevel() > 0) {
-                curr_state = State::CLEANING;
-                return nextStep();
-            }
-            if(curr_pos != docking_station) {
-                if (explorer_.getDistance(curr_pos) >= sensors_->getBatteryState() - 1){
-                    curr_state = State::TO_DOCK;
-                    return nextStep();
-                }
-            }
-            for (Direction dir: PositionUtils::getDirectionOrder()) {
-                possible_pos = curr_pos;
-                updatePosition(Step(dir), possible_pos);
-                if (sensors_->isWall(dir) || explorer_.explored(possible_pos)){
-                    continue;
-                }
-                steps_counter++;
-                return Step(dir);
-            }
-            if(!explorer_.areAllAreasExplored()){
-                last_dirty_pos_ = {explorer_.getClosestUnexploredArea(curr_pos).r, explorer_.getClosestUnexploredArea(curr_pos).c};
-                curr_state = State::TO_POS;
-            }else curr_state = State::TO_DOCK;
-            return nextStep();
-            break;
-        }
+    distance = queries_.closest_unexplored_distance;
+    return queries_.closest_unexplored;
+}
 
-        case State::TO_DOCK: {
-            prev_state = curr_state;
-            explorer_.setDistance(curr_pos, getMinDistanceOfNeighbors(curr_pos));
-            auto path = explorer_.getShortestPath_A(sensors_->getCurrentPosition(),
-                                                    {docking_station.r, docking_station.c}, false);
-            if (!path.empty()) {
-                Step next = Step(path.top());
-                path.pop();
-                steps_counter++;
-                return next;
-            }
-            if (explorer_.isDockingStation(curr_pos)) {
-                curr_state = State::CHARGING;
-                steps_counter++;
-                return Step::Stay;
-            }
-            break;
+// Handlers of the states in the order State declares them; DFS never tours
+constexpr std::array<AlgorithmDFS::StateHandler, kStateCount> AlgorithmDFS::kStateHandlers = {
+        &AlgorithmDFS::handleCharging,
+        &AlgorithmDFS::handleToDock,
+        &AlgorithmDFS::handleToPos,
+        &AlgorithmDFS::handleFinish,
+        &AlgorithmDFS::handleExplore,
+        &AlgorithmDFS::handleCleaning,
+        &AlgorithmDFS::handleFinish,
+};
+
+Step AlgorithmDFS::nextStep() {
+    snapshot_ = sensors_.read();
+    if (!snapshot_) {
+        return Step::Finish; // neither a snapshot nor the sensors were given
+    }
+    max_battery_ = sensors_.getMaxBattery();
+    return sensors_.taken(decideStep());
+}
+
+// Runs the handler of the current state until one returns a step. Searches are shared by every state visited
+// during one step, so each runs at most once per map version.
+Step AlgorithmDFS::decideStep() {
+    queries_ = StepQueries();
+    Position curr_pos = snapshot_->position;
+    for (int transition = 0; transition < kMaxTransitions; ++transition) {
+        std::cout << "curr_state: " << stateToString(curr_state) << std::endl;
+        if(planToDock(curr_pos).size() >= (max_steps_ - steps_counter)){
+            curr_state = State::TO_DOCK;
+        }
+        if(curr_pos==docking_station){
+            int distance;
+            closestUnexploredArea(curr_pos, distance);
+            if(distance >= 0 && distance >= (max_steps_ - steps_counter)){return Step::Finish; }
         }
+        if (std::optional<Step> step = (this->*kStateHandlers[static_cast<std::size_t>(curr_state)])(curr_pos)) {
+            return *step;
+        }
+    }
+    // The states kept handing over to each other, wait for the next step
+    steps_counter++;
+    return Step::Stay;
+}
 
-        case State::TO_POS: {
-            prev_state = curr_state;
-            std::stack<Direction> path;
-            if (last_dirty_pos_ == std::make_pair(-20, -20)) {
-                if (explorer_.explored(curr_pos)) {
-                    path = explorer_.getShortestPath_A(sensors_->getCurrentPosition(), last_dirty_pos_, true);
-                } else{
-                    curr_state = State::EXPLORE;
-                    return nextStep();
-                }
-            }else {
-                path = explorer_.getShortestPath_A(sensors_->getCurrentPosition(), last_dirty_pos_, false);
-            }
-            if (path.size() >= sensors_->getBatteryState()-2) {
-                curr_state = State::TO_DOCK;
-                return nextStep();
-            }
-            if (!path.empty()) {
-                Step next = Step(path.top());
-                path.pop();
-                steps_counter++;
-                return next;
-            }
-            curr_state = (sensors_->dirtLevel() > 0) ? State::CLEANING : State::EXPLORE;
-            return nextStep();
-            break;
+std::optional<Step> AlgorithmDFS::handleExplore(const Position& curr_pos) {
+    updateExplorerInfo(curr_pos);
+    if (snapshot_->dirt > 0) {
+        curr_state = State::CLEANING;
+        return std::nullopt;
+    }
+    if(curr_pos != docking_station) {
+        if (explorer_.getDistance(curr_pos) >= snapshot_->battery - 1){
+            curr_state = State::TO_DOCK;
+            return std::nullopt;
         }
+    }
+    for (Direction dir: PositionUtils::getDirectionOrder()) {
+        Position possible_pos = curr_pos;
+        updatePosition(Step(dir), possible_pos);
+        if (snapshot_->isWall(dir) || explorer_.explored(possible_pos)){
+            continue;
+        }
+        steps_counter++;
+        return Step(dir);
+    }
+    if(!explorer_.areAllAreasExplored()){
+        int distance;
+        Position pos = closestUnexploredArea(curr_pos, distance);
+        last_dirty_pos_ = {pos.r, pos.c};
+        curr_state = State::TO_POS;
+    }else curr_state = State::TO_DOCK;
+    return std::nullopt;
+}
 
-        case State::CLEANING: {
-            prev_state = curr_state;
-            std::pair<int, int> dock = {docking_station.r, docking_station.c};
-            auto path = explorer_.getShortestPath_A(sensors_->getCurrentPosition(), dock, false);
-            if (path.size() >= sensors_->getBatteryState() - 2) {
-                curr_state = State::TO_DOCK;
-                if (sensors_->dirtLevel() > 0) {
-                    last_dirty_pos_ = sensors_->getCurrentPosition();
-                } else last_dirty_pos_ = {-20, -20};
-                Step s = Step(path.top());
-                path.pop();
-                steps_counter++;
-                return s;
-            }
-            if (sensors_->dirtLevel() == 0) {
-                curr_state = State::EXPLORE;
-                return nextStep();
-            }
-            explorer_.updateDirtAndClean(curr_pos, sensors_->dirtLevel());
-            steps_counter++;
-            return Step::Stay;
+std::optional<Step> AlgorithmDFS::handleToDock(const Position& curr_pos) {
+    prev_state = curr_state;
+    explorer_.setDistance(curr_pos, getMinDistanceOfNeighbors(curr_pos));
+    if (!planToDock(curr_pos).empty()) {
+        steps_counter++;
+        return Step(dock_plan_.next());
+    }
+    if (explorer_.isDockingStation(curr_pos)) {
+        curr_state = State::CHARGING;
+        steps_counter++;
+        return Step::Stay;
+    }
+    return Step::Stay;
+}
+
+std::optional<Step> AlgorithmDFS::handleToPos(const Position& curr_pos) {
+    prev_state = curr_state;
+    if (last_dirty_pos_ == std::make_pair(-20, -20)) {
+        if (explorer_.explored(curr_pos)) {
+            explorer_.updatePlan(pos_plan_, {curr_pos.r, curr_pos.c}, last_dirty_pos_, true);
+        } else{
+            curr_state = State::EXPLORE;
+            return std::nullopt;
         }
+    }else {
+        explorer_.updatePlan(pos_plan_, {curr_pos.r, curr_pos.c}, last_dirty_pos_, false);
+    }
+    if (pos_plan_.size() >= snapshot_->battery-2) {
+        curr_state = State::TO_DOCK;
+        return std::nullopt;
+    }
+    if (!pos_plan_.empty()) {
+        steps_counter++;
+        return Step(pos_plan_.next());
+    }
+    curr_state = (snapshot_->dirt > 0) ? State::CLEANING : State::EXPLORE;
+    return std::nullopt;
+}
 
-        case State::CHARGING: {
-            prev_state = curr_state;
-            if (sensors_->getBatteryState() == sensors_->getMaxBattery()) {
-                curr_state = State::TO_POS;
-                return nextStep();
-            }
+std::optional<Step> AlgorithmDFS::handleCleaning(const Position& curr_pos) {
+    prev_state = curr_state;
+    if (planToDock(curr_pos).size() >= snapshot_->battery - 2) {
+        curr_state = State::TO_DOCK;
+        if (snapshot_->dirt > 0) {
+            last_dirty_pos_ = {curr_pos.r, curr_pos.c};
+        } else last_dirty_pos_ = {-20, -20};
+        if (dock_plan_.empty()) {
+            // Already at the docking station, nothing to walk back
             steps_counter++;
             return Step::Stay;
         }
+        steps_counter++;
+        return Step(dock_plan_.next());
+    }
+    if (snapshot_->dirt == 0) {
+        curr_state = State::EXPLORE;
+        return std::nullopt;
+    }
+    explorer_.updateDirtAndClean(curr_pos, snapshot_->dirt);
+    steps_counter++;
+    return Step::Stay;
+}
 
-        case State::FINISH: {
-            break;
-/*            if (StateChanged()) {
-                prev_state = curr_state;
-                return Step::Finish;
-            } else {
-                prev_state = curr_state;
-                curr_state = State::EXPLORE;
-                return nextStep();
-            }*/
-        }
+std::optional<Step> AlgorithmDFS::handleCharging(const Position&) {
+    prev_state = curr_state;
+    if (snapshot_->battery == max_battery_) {
+        curr_state = State::TO_POS;
+        return std::nullopt;
     }
-    return Step::Stay;  // Default fallback
+    steps_counter++;
+    return Step::Stay;
 }
 
+std::optional<Step> AlgorithmDFS::handleFinish(const Position&) {
+    return Step::Stay;
+}
 
 
 extern "C" {
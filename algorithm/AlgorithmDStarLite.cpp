@@ -0,0 +1,276 @@
+#include "AlgorithmDStarLite.h"
+#include "AlgorithmRegistration.h"
+#include <algorithm>
+#include <utility>
+
+AlgorithmDStarLite::AlgorithmDStarLite() : dock_search_(explorer_), target_search_(explorer_) {
+}
+
+void AlgorithmDStarLite::setSensorSnapshot(const SensorSnapshot &snapshot, std::size_t maxBattery) {
+    sensors_.setSnapshot(snapshot, maxBattery);
+    startAt(snapshot.position);
+}
+
+void AlgorithmDStarLite::startAt(const Position& dock) {
+    docking_station_ = dock;
+    explorer_.setDockingStation(docking_station_);
+    dock_search_.setGoal(docking_station_);
+}
+
+void AlgorithmDStarLite::reset() {
+    max_steps_ = 0;
+    steps_counter_ = 0;
+    sensors_ = SensorFeed();
+    snapshot_ = nullptr;
+    max_battery_ = 0;
+    docking_station_ = {0, 0};
+    explorer_.reset();
+    dock_search_.clearGoal();
+    target_search_.clearGoal();
+    returning_ = false;
+    charging_ = false;
+    battery_drift_ = 0;
+    batch_.clear();
+    batch_to_dock_ = false;
+}
+
+// The map lives in resource, which the worker keeps for the next run of this instance; reset() clears it in place
+void AlgorithmDStarLite::setMemoryResource(std::pmr::memory_resource *resource) {
+    explorer_.reset(resource);
+}
+
+void AlgorithmDStarLite::setMaxSteps(std::size_t maxSteps) {
+    max_steps_ = maxSteps;
+}
+
+void AlgorithmDStarLite::setWallsSensor(const WallsSensor& wallsSensor) {
+    sensors_.setWallsSensor(wallsSensor);
+}
+
+void AlgorithmDStarLite::setDirtSensor(const DirtSensor& dirtSensor) {
+    sensors_.setDirtSensor(dirtSensor);
+}
+
+// Without a snapshot, which the simulator passes after the setters, the position is followed from the docking
+// station, see SensorFeed
+void AlgorithmDStarLite::setBatteryMeter(const BatteryMeter& batteryMeter) {
+    sensors_.setBatteryMeter(batteryMeter);
+    if (!sensors_.hasSnapshot()) {
+        startAt(SensorFeed::kTrackedDock);
+    }
+}
+
+int AlgorithmDStarLite::getMinDistanceOfNeighbors(const Position& curr_pos) {
+    if (curr_pos == docking_station_) return 0;
+    int minDistance = -1;
+    for (const auto& dir : {Direction::North, Direction::East, Direction::South, Direction::West}) {
+        Position neighbor = PositionUtils::movePosition(curr_pos, dir);
+        if (explorer_.isKnownFloor(neighbor)) {
+            int neighborDistance = explorer_.getDistance(neighbor);
+            if (neighborDistance >= 0 && (minDistance < 0 || neighborDistance + 1 < minDistance)) {
+                minDistance = neighborDistance + 1;
+            }
+        }
+    }
+    return minDistance;
+}
+
+void AlgorithmDStarLite::updateExplorerInfo(const Position& curr_pos) {
+    if (!explorer_.isKnownFloor(curr_pos)) {
+        explorer_.setDirtLevel(curr_pos, snapshot_->dirt);
+        explorer_.setDistance(curr_pos, getMinDistanceOfNeighbors(curr_pos));
+        explorer_.removeFromUnexplored(curr_pos);
+        for (const auto& dir : {Direction::North, Direction::East, Direction::South, Direction::West}) {
+            explorer_.updateAdjacentArea(dir, curr_pos, snapshot_->isWall(dir));
+        }
+    } else {
+        explorer_.setDirtLevel(curr_pos, snapshot_->dirt);
+    }
+}
+
+bool AlgorithmDStarLite::isWorkLeft(const Position& target) {
+    if (explorer_.isAreaUnexplored(target)) {
+        return true;
+    }
+    return explorer_.isKnownFloor(target) && explorer_.getDirtLevel(target) > 0;
+}
+
+// Steps needed to reach target, clean it once if it is dirty and get back to the docking station,
+// or INT_MAX if the way back is not known
+int AlgorithmDStarLite::getTargetCost(const Position& target, int distance) {
+    if (explorer_.isAreaUnexplored(target)) {
+        int back = explorer_.getFrontierDockDistance(target);
+        return back < 0 ? INT_MAX : distance + back;
+    }
+    int back = explorer_.getDistance(target);
+    return back < 0 ? INT_MAX : distance + back + 1;
+}
+
+// Point target_search_ at the closest dirt or unexplored area that can be handled within budget steps,
+// trying the closer of the two first
+bool AlgorithmDStarLite::chooseTarget(const Position& curr_pos, int budget) {
+    std::pair<int, Position> candidates[2];
+    candidates[0].second = explorer_.getClosestDirtyArea(curr_pos, candidates[0].first);
+    candidates[1].second = explorer_.getClosestUnexploredArea(curr_pos, candidates[1].first);
+    if (candidates[1].first >= 0 && (candidates[0].first < 0 || candidates[1].first < candidates[0].first)) {
+        std::swap(candidates[0], candidates[1]);
+    }
+    for (const auto& [distance, target] : candidates) {
+        if (distance < 0) {
+            continue;
+        }
+        if (!target_search_.hasGoal() || target_search_.getGoal() != target) {
+            target_search_.setGoal(target);
+        }
+        int path = target_search_.update(curr_pos);
+        if (path >= 0 && getTargetCost(target, path) <= budget) {
+            return true;
+        }
+    }
+    target_search_.clearGoal();
+    return false;
+}
+
+Step AlgorithmDStarLite::follow(const DStarLite& search, const Position& curr_pos) {
+    Direction dir;
+    steps_counter_++;
+    if (!search.nextMove(dir)) {
+        battery_drift_++;
+        return Step::Stay;
+    }
+    if (PositionUtils::movePosition(curr_pos, dir) == docking_station_) {
+        battery_drift_++;
+    }
+    return Step(dir);
+}
+
+// Running out of steps scores as if nothing was cleaned, so keep two steps to be docked and return Finish
+std::size_t AlgorithmDStarLite::getRemainingSteps() const {
+    return max_steps_ > steps_counter_ + 2 ? max_steps_ - steps_counter_ - 2 : 0;
+}
+
+// Batches cover the two cases where nextStep() would not learn anything new: walking home over explored
+// floor once returning, and staying at the docking station until charged
+std::span<const Step> AlgorithmDStarLite::nextSteps(BatchTrigger &triggers) {
+    snapshot_ = sensors_.read();
+    if (!snapshot_) {
+        return {};
+    }
+    max_battery_ = sensors_.getMaxBattery();
+    batch_.clear();
+    batch_to_dock_ = false;
+    Position curr_pos = snapshot_->position;
+    if (returning_ && curr_pos != docking_station_ && explorer_.isKnownFloor(curr_pos)) {
+        dock_search_.update(curr_pos);
+        for (Direction dir : dock_search_.getPath()) {
+            batch_.push_back(Step(dir));
+        }
+        batch_to_dock_ = !batch_.empty();
+        triggers = BatchTrigger::None;
+    } else if (charging_ && curr_pos == docking_station_ &&
+               (explorer_.hasMoreDirtyAreas() || !explorer_.areAllAreasExplored())) {
+        // Same rule as nextStep(): charge while the battery is below both its maximum and the steps left
+        double battery = snapshot_->battery;
+        double maxBattery = max_battery_;
+        std::size_t remaining = getRemainingSteps();
+        while (battery < maxBattery && battery < remaining) {
+            batch_.push_back(Step::Stay);
+            battery = std::min(maxBattery, battery + maxBattery * 0.05);
+            remaining = remaining > 0 ? remaining - 1 : 0;
+        }
+        triggers = BatchTrigger::BatteryFull;
+    }
+    return batch_;
+}
+
+void AlgorithmDStarLite::stepsConsumed(std::size_t count) {
+    steps_counter_ += count;
+    for (std::size_t i = 0; i < count && i < batch_.size(); ++i) {
+        sensors_.taken(batch_[i]);
+    }
+    if (count == 0) {
+        return;
+    }
+    if (batch_to_dock_) {
+        if (count == batch_.size()) {
+            battery_drift_++;
+        }
+    } else {
+        battery_drift_ = 0;
+    }
+}
+
+Step AlgorithmDStarLite::nextStep() {
+    snapshot_ = sensors_.read();
+    if (!snapshot_) {
+        return Step::Finish; // neither a snapshot nor the sensors were given
+    }
+    max_battery_ = sensors_.getMaxBattery();
+    return sensors_.taken(decideStep());
+}
+
+Step AlgorithmDStarLite::decideStep() {
+    Position curr_pos = snapshot_->position;
+    updateExplorerInfo(curr_pos);
+    int dock_distance = dock_search_.update(curr_pos);
+    if (dock_distance >= 0) {
+        explorer_.setDistance(curr_pos, dock_distance);
+    }
+    std::size_t remaining = getRemainingSteps();
+    std::size_t battery = snapshot_->battery;
+    int budget = static_cast<int>(std::min(battery, remaining)) - battery_drift_;
+
+    if (curr_pos == docking_station_) {
+        if (!explorer_.hasMoreDirtyAreas() && explorer_.areAllAreasExplored()) {
+            return Step::Finish;
+        }
+        if (returning_) {
+            returning_ = false;
+            charging_ = true;
+        }
+        if (charging_ && battery < max_battery_ && battery < remaining) {
+            battery_drift_ = 0;
+            steps_counter_++;
+            return Step::Stay;
+        }
+        charging_ = false;
+    }
+
+    if (!returning_) {
+        if (target_search_.hasGoal() && isWorkLeft(target_search_.getGoal())) {
+            int path = target_search_.update(curr_pos);
+            if (path < 0 || getTargetCost(target_search_.getGoal(), path) > budget) {
+                target_search_.clearGoal();
+            }
+        } else {
+            target_search_.clearGoal();
+        }
+        if (target_search_.hasGoal() || chooseTarget(curr_pos, budget)) {
+            if (target_search_.getGoal() == curr_pos) {
+                // Dirty, clean it
+                steps_counter_++;
+                return Step::Stay;
+            }
+            return follow(target_search_, curr_pos);
+        }
+        returning_ = true;
+    }
+
+    if (curr_pos == docking_station_) {
+        returning_ = false;
+        // Charge only if a full battery makes some work reachable
+        std::size_t fullBudget = std::min(max_battery_, remaining);
+        if (battery < fullBudget && chooseTarget(curr_pos, static_cast<int>(fullBudget))) {
+            charging_ = true;
+            battery_drift_ = 0;
+            steps_counter_++;
+            return Step::Stay;
+        }
+        return Step::Finish;
+    }
+    return follow(dock_search_, curr_pos);
+}
+
+extern "C" {
+REGISTER_ALGORITHM(AlgorithmDStarLite);
+}
@@ -0,0 +1,71 @@
+#ifndef VACUUM_FINAL_ALGORITHMDSTARLITE_H
+#define VACUUM_FINAL_ALGORITHMDSTARLITE_H
+
+#include "../simulator/Explorer.h"
+#include "../simulator/DStarLite.h"
+#include "../common/AbstractAlgorithm.h"
+#include "../common/BatchedAlgorithm.h"
+#include "../common/ResettableAlgorithm.h"
+#include "../common/AllocatorAwareAlgorithm.h"
+#include "../common/SnapshotAlgorithm.h"
+#include "../common/SensorFeed.h"
+#include "../common/states.h"
+
+// Cleans the closest dirt or explores the closest unexplored area, navigating with D* Lite.
+// The search tree towards the docking station lives for the whole run and is only repaired as the map grows,
+// the one towards the current target lives until the target is reached or dropped.
+// The way home over explored floor and runs of charging steps are handed to the simulator as batches.
+// Targets are taken nearest first and every return to the dock charges to full, so on small houses whose work
+// needs less than a full battery it can take more steps than AlgorithmDFS (test2.house, test4.house); houses
+// where the battery or the step limit binds are where it gains.
+class AlgorithmDStarLite : public AbstractAlgorithm, public BatchedAlgorithm, public ResettableAlgorithm,
+                           public AllocatorAwareAlgorithm, public SnapshotAlgorithm {
+public:
+    AlgorithmDStarLite();
+    virtual ~AlgorithmDStarLite() = default;
+    void setMaxSteps(std::size_t maxSteps) override;
+    void setWallsSensor(const WallsSensor &) override;
+    void setDirtSensor(const DirtSensor &) override;
+    void setBatteryMeter(const BatteryMeter &) override;
+    Step nextStep() override;
+    std::span<const Step> nextSteps(BatchTrigger &triggers) override;
+    void stepsConsumed(std::size_t count) override;
+    void reset() override;
+    void setMemoryResource(std::pmr::memory_resource *resource) override;
+    void setSensorSnapshot(const SensorSnapshot &snapshot, std::size_t maxBattery) override;
+
+private:
+    void startAt(const Position& dock);
+    Step decideStep();
+
+    std::size_t max_steps_ = 0;
+    std::size_t steps_counter_ = 0;
+    SensorFeed sensors_;
+    const SensorSnapshot* snapshot_ = nullptr; // this step's readings, from sensors_
+    std::size_t max_battery_ = 0;
+    Position docking_station_ = {0, 0};
+
+    Explorer explorer_;
+    DStarLite dock_search_;   // goal is the docking station
+    DStarLite target_search_; // goal is the dirt or unexplored area being worked on
+
+    bool returning_ = false; // heading back to charge, not looking for work until docked
+    bool charging_ = false;
+    // Steps the simulator's Vacuum pays for but the battery meter does not (entering the docking station,
+    // staying on a clean cell). The Vacuum stops moving when its own battery runs out, so these are kept out
+    // of the budget until the next charge brings both back in line.
+    int battery_drift_ = 0;
+
+    std::vector<Step> batch_;
+    bool batch_to_dock_ = false; // batch_ ends at the docking station
+
+    void updateExplorerInfo(const Position& curr_pos);
+    int getMinDistanceOfNeighbors(const Position& curr_pos);
+    bool isWorkLeft(const Position& target);
+    int getTargetCost(const Position& target, int distance);
+    bool chooseTarget(const Position& curr_pos, int budget);
+    Step follow(const DStarLite& search, const Position& curr_pos);
+    std::size_t getRemainingSteps() const;
+};
+
+#endif //VACUUM_FINAL_ALGORITHMDSTARLITE_H
@@ -2,13 +2,40 @@
 #include "AlgorithmRegistration.h"
 
 Algorithm_212346076_207177197_B::Algorithm_212346076_207177197_B() :
-        sensors_(nullptr), max_steps_(0), prev_state(State::EXPLORE), curr_state(State::EXPLORE) {
+        snapshot_(nullptr), max_steps_(0), prev_state(State::EXPLORE), curr_state(State::EXPLORE) {
     explorer_ = Explorer();
 }
 
-void Algorithm_212346076_207177197_B::setSensors(SensorImpl &sensors) {
-    sensors_ = &sensors;
-    docking_station = {sensors_->getCurrentPosition().first, sensors_->getCurrentPosition().second};
+void Algorithm_212346076_207177197_B::setSensorSnapshot(const SensorSnapshot &snapshot, std::size_t maxBattery) {
+    sensors_.setSnapshot(snapshot, maxBattery);
+    startAt(snapshot.position);
+}
+
+void Algorithm_212346076_207177197_B::startAt(const Position& dock) {
+    docking_station = dock;
+    explorer_.setDockingStation(docking_station);
+}
+
+void Algorithm_212346076_207177197_B::reset() {
+    max_steps_ = 0;
+    steps_counter = 0;
+    sensors_ = SensorFeed();
+    snapshot_ = nullptr;
+    max_battery_ = 0;
+    bfs_queue = std::queue<Position>();
+    explorer_.reset();
+    dock_plan_ = PathPlan();
+    pos_plan_ = PathPlan();
+    prev_state = State::EXPLORE;
+    curr_state = State::EXPLORE;
+    docking_station = {0, 0};
+    last_dirty_pos_ = {-20, -20};
+    queries_ = StepQueries();
+}
+
+// The map lives in resource, which the worker keeps for the next run of this instance; reset() clears it in place
+void Algorithm_212346076_207177197_B::setMemoryResource(std::pmr::memory_resource *resource) {
+    explorer_.reset(resource);
 }
 
 void Algorithm_212346076_207177197_B::setMaxSteps(std::size_t maxSteps) {
@@ -16,15 +43,20 @@ void Algorithm_212346076_207177197_B::setMaxSteps(std::size_t maxSteps) {
 }
 
 void Algorithm_212346076_207177197_B::setWallsSensor(const WallsSensor& wallsSensor) {
-    setSensors(const_cast<SensorImpl&>(dynamic_cast<const SensorImpl&>(wallsSensor)));
+    sensors_.setWallsSensor(wallsSensor);
 }
 
 void Algorithm_212346076_207177197_B::setDirtSensor(const DirtSensor& dirtSensor) {
-    setSensors(const_cast<SensorImpl&>(dynamic_cast<const SensorImpl&>(dirtSensor)));
+    sensors_.setDirtSensor(dirtSensor);
 }
 
+// Without a snapshot, which the simulator passes after the setters, the position is followed from the docking
+// station, see SensorFeed
 void Algorithm_212346076_207177197_B::setBatteryMeter(const BatteryMeter& batteryMeter) {
-    setSensors(const_cast<SensorImpl&>(dynamic_cast<const SensorImpl&>(batteryMeter)));
+    sensors_.setBatteryMeter(batteryMeter);
+    if (!sensors_.hasSnapshot()) {
+        startAt(SensorFeed::kTrackedDock);
+    }
 }
 
 bool Algorithm_212346076_207177197_B::StateChanged() const {
@@ -38,17 +70,14 @@ State Algorithm_212346076_207177197_B::getCurrentState() const {
 int Algorithm_212346076_207177197_B::getMinDistanceOfNeighbors(const Position& curr_pos) {
     if (curr_pos == docking_station) return 0;
     int minDistance = INT_MAX;
-    std::vector<std::pair<int, int>> neighbors = explorer_.getNeighbors({curr_pos.r, curr_pos.c});
-
-    for (const auto& neighborPair : neighbors) {
-        Position neighbor = {neighborPair.first, neighborPair.second};
+    explorer_.forEachNeighbor(curr_pos, [&](const Position& neighbor) {
         if (explorer_.explored(neighbor)) {
             int neighborDistance = explorer_.getDistance(neighbor);
             if (neighborDistance+1 < minDistance) {
                 minDistance = neighborDistance + 1;
             }
         }
-    }
+    });
 
     if (minDistance == INT_MAX) {
         // None of the neighbors are explored. Handle this case accordingly.
@@ -59,16 +88,16 @@ int Algorithm_212346076_207177197_B::getMinDistanceOfNeighbors(const Position& c
 
 void Algorithm_212346076_207177197_B::updateExplorerInfo(Position current_position_) {
     if (!explorer_.explored(current_position_)) {
-        explorer_.setDirtLevel(current_position_, sensors_->dirtLevel());
+        explorer_.setDirtLevel(current_position_, snapshot_->dirt);
         explorer_.setDistance(current_position_, getMinDistanceOfNeighbors(current_position_));
         explorer_.removeFromUnexplored(current_position_);
 
         // Update adjacent areas for newly explored positions
         for (const auto& dir : {Direction::North, Direction::East, Direction::South, Direction::West}) {
-            explorer_.updateAdjacentArea(dir, current_position_, sensors_->isWall(dir));
+            explorer_.updateAdjacentArea(dir, current_position_, snapshot_->isWall(dir));
         }
     } else {
-        explorer_.updateDirtAndClean(current_position_, sensors_->dirtLevel());
+        explorer_.updateDirtAndClean(current_position_, snapshot_->dirt);
     }
 }
 
@@ -95,178 +124,215 @@ std::string Algorithm_212346076_207177197_B::stateToString(State state) {
     }
 }
 
-Step Algorithm_212346076_207177197_B::nextStep() {
-    std::cout << "curr_state: " << stateToString(curr_state) << std::endl;
-    Position curr_pos = {sensors_->getCurrentPosition().first, sensors_->getCurrentPosition().second};
-    auto path = explorer_.getShortestPath_A(sensors_->getCurrentPosition(),
-                                            {docking_station.r, docking_station.c}, false);
-    if(path.size()+2 >= (max_steps_ - steps_counter)){
-        curr_state = State::TO_DOCK;
+// Dock plan for this step; the explorer only replans when the kept plan can no longer be followed
+const PathPlan& Algorithm_212346076_207177197_B::planToDock(const Position& curr_pos) {
+    if (queries_.dock_plan_version != explorer_.getMapVersion()) {
+        explorer_.updatePlan(dock_plan_, {curr_pos.r, curr_pos.c}, {docking_station.r, docking_station.c}, false);
+        queries_.dock_plan_version = explorer_.getMapVersion();
     }
-    if(curr_pos==docking_station){
-        Position pos = explorer_.getClosestUnexploredArea(curr_pos);
-        path = explorer_.getShortestPath_A(sensors_->getCurrentPosition(), {pos.c,pos.r},false);
-        if((path.size()>= (max_steps_ - steps_counter))){return Step::Finish; }
+    return dock_plan_;
+}
 
+Position Algorithm_212346076_207177197_B::closestUnexploredArea(const Position& curr_pos, int& distance) {
+    if (queries_.closest_unexplored_version != explorer_.getMapVersion()) {
+        queries_.closest_unexplored = explorer_.getClosestUnexploredArea(curr_pos, queries_.closest_unexplored_distance);
+        queries_.closest_unexplored_version = explorer_.getMapVersion();
     }
-    Position possible_pos = curr_pos;
-    switch (curr_state) {
-        case State::EXPLORE: {
-            updateExplorerInfo(curr_pos);
-
-            if (sensors_->dirtLevel() > 0) {
-                curr_state = State::CLEANING;
-                return nextStep();
-            }
-
-            // Check if current position is too far from the dock
-            if(curr_pos != docking_station) {
-                if (explorer_.getDistance(curr_pos) >= sensors_->getBatteryState()-2 ) {
-                    curr_state = State::TO_DOCK;
-                    return nextStep();
-                }
-            }
-
-            // If the BFS queue is empty, try adding new positions to explore
-            if (bfs_queue.empty()) {
-                for (Direction dir : PositionUtils::getDirectionOrder()) {
-                    possible_pos = curr_pos;
-                    updatePosition(Step(dir), possible_pos);
+    distance = queries_.closest_unexplored_distance;
+    return queries_.closest_unexplored;
+}
 
-                    if (!sensors_->isWall(dir) && !explorer_.explored(possible_pos)) {
-                        bfs_queue.push(possible_pos);
-                    }
-                }
-            }
+// Handlers of the states in the order State declares them; this algorithm never tours
+constexpr std::array<Algorithm_212346076_207177197_B::StateHandler, kStateCount> Algorithm_212346076_207177197_B::kStateHandlers = {
+        &Algorithm_212346076_207177197_B::handleCharging,
+        &Algorithm_212346076_207177197_B::handleToDock,
+        &Algorithm_212346076_207177197_B::handleToPos,
+        &Algorithm_212346076_207177197_B::handleFinish,
+        &Algorithm_212346076_207177197_B::handleExplore,
+        &Algorithm_212346076_207177197_B::handleCleaning,
+        &Algorithm_212346076_207177197_B::handleFinish,
+};
 
-            // If there are positions in the BFS queue, find a path to the next position
-            if (!bfs_queue.empty()) {
-                Position next_pos = bfs_queue.front();
-                bfs_queue.pop();
+Step Algorithm_212346076_207177197_B::nextStep() {
+    snapshot_ = sensors_.read();
+    if (!snapshot_) {
+        return Step::Finish; // neither a snapshot nor the sensors were given
+    }
+    max_battery_ = sensors_.getMaxBattery();
+    return sensors_.taken(decideStep());
+}
 
-                // Backtrack to the original position before moving to the next position
-                std::stack<Direction> path_back = explorer_.getShortestPath_A({curr_pos.r,curr_pos.c}, {next_pos.r,next_pos.c}, false);
+// Runs the handler of the current state until one returns a step. Searches are shared by every state visited
+// during one step, so each runs at most once per map version.
+Step Algorithm_212346076_207177197_B::decideStep() {
+    queries_ = StepQueries();
+    Position curr_pos = snapshot_->position;
+    for (int transition = 0; transition < kMaxTransitions; ++transition) {
+        std::cout << "curr_state: " << stateToString(curr_state) << std::endl;
+        if(planToDock(curr_pos).size()+2 >= (max_steps_ - steps_counter)){
+            curr_state = State::TO_DOCK;
+        }
+        if(curr_pos==docking_station){
+            int distance;
+            closestUnexploredArea(curr_pos, distance);
+            if(distance >= 0 && distance >= (max_steps_ - steps_counter)){return Step::Finish; }
+        }
+        if (std::optional<Step> step = (this->*kStateHandlers[static_cast<std::size_t>(curr_state)])(curr_pos)) {
+            return *step;
+        }
+    }
+    // The states kept handing over to each other, wait for the next step
+    steps_counter++;
+    return Step::Stay;
+}
 
-                if (!path_back.empty()) {
-                    // If backtracking is required, take the first step in the backtracking path
-                    Step next_step = Step(path_back.top());
-                    path_back.pop();
-                    steps_counter++;
-                    return next_step;
-                } else {
-                    // No backtracking needed, directly move to the next position
-                    for (Direction dir : PositionUtils::getDirectionOrder()) {
-                        possible_pos = curr_pos;
-                        updatePosition(Step(dir), possible_pos);
-
-                        if (possible_pos == next_pos) {
-                            steps_counter++;
-                            return Step(dir);
-                        }
-                    }
-                }
-            }
+std::optional<Step> Algorithm_212346076_207177197_B::handleExplore(const Position& curr_pos) {
+    updateExplorerInfo(curr_pos);
 
-            // If BFS queue is empty and there are unexplored areas, go to the closest one
-            if (bfs_queue.empty() && !explorer_.areAllAreasExplored()) {
-                Position pos = explorer_.getClosestUnexploredArea(curr_pos);
-                last_dirty_pos_ = {pos.r, pos.c};
-                curr_state = State::TO_POS;
-                return nextStep();  // Immediately proceed to TO_POS logic
-            } else if (bfs_queue.empty()) {
-                // If BFS queue is empty and all areas are explored, go back to the dock
-                curr_state = State::TO_DOCK;
-                return nextStep();
-                break;
-            }
+    if (snapshot_->dirt > 0) {
+        curr_state = State::CLEANING;
+        return std::nullopt;
+    }
 
-            return Step::Stay;
+    // Check if current position is too far from the dock
+    if(curr_pos != docking_station) {
+        if (explorer_.getDistance(curr_pos) >= snapshot_->battery-2 ) {
+            curr_state = State::TO_DOCK;
+            return std::nullopt;
         }
+    }
 
-        case State::TO_DOCK: {
-            prev_state = curr_state;
-            explorer_.setDistance(curr_pos, getMinDistanceOfNeighbors(curr_pos));
-            auto path = explorer_.getShortestPath_A(sensors_->getCurrentPosition(),
-                                                    {docking_station.r, docking_station.c}, false);
-            if (!path.empty()) {
-                Step next = Step(path.top());
-                path.pop();
-                steps_counter++;
-                return next;
-            }
-            if (explorer_.isDockingStation(curr_pos)) {
-                curr_state = State::CHARGING;
-                steps_counter++;
-                return Step::Stay;
+    // If the BFS queue is empty, try adding new positions to explore
+    if (bfs_queue.empty()) {
+        for (Direction dir : PositionUtils::getDirectionOrder()) {
+            Position possible_pos = curr_pos;
+            updatePosition(Step(dir), possible_pos);
+
+            if (!snapshot_->isWall(dir) && !explorer_.explored(possible_pos)) {
+                bfs_queue.push(possible_pos);
             }
-            break;
         }
+    }
+
+    // If there are positions in the BFS queue, find a path to the next position
+    if (!bfs_queue.empty()) {
+        Position next_pos = bfs_queue.front();
+        bfs_queue.pop();
 
-        case State::TO_POS: {
-            prev_state = curr_state;
-            std::stack<Direction> path;
-            if (last_dirty_pos_ == std::make_pair(-20, -20)) {
-                if (explorer_.explored(curr_pos)) {
-                    path = explorer_.getShortestPath_A(sensors_->getCurrentPosition(), last_dirty_pos_, true);
-                } else{
-                    curr_state = State::EXPLORE;
-                    return nextStep();
+        // Backtrack to the original position before moving to the next position
+        std::stack<Direction> path_back = explorer_.getShortestPath_A({curr_pos.r,curr_pos.c}, {next_pos.r,next_pos.c}, false);
+
+        if (!path_back.empty()) {
+            // If backtracking is required, take the first step in the backtracking path
+            Step next_step = Step(path_back.top());
+            path_back.pop();
+            steps_counter++;
+            return next_step;
+        } else {
+            // No backtracking needed, directly move to the next position
+            for (Direction dir : PositionUtils::getDirectionOrder()) {
+                Position possible_pos = curr_pos;
+                updatePosition(Step(dir), possible_pos);
+
+                if (possible_pos == next_pos) {
+                    steps_counter++;
+                    return Step(dir);
                 }
-            }else {
-                path = explorer_.getShortestPath_A(sensors_->getCurrentPosition(), last_dirty_pos_, false);
-            }
-            if (path.size() >= sensors_->getBatteryState()-2) {
-                curr_state = State::TO_DOCK;
-                return nextStep();
             }
-            if (!path.empty()) {
-                Step next = Step(path.top());
-                path.pop();
-                steps_counter++;
-                return next;
-            }
-            curr_state = (sensors_->dirtLevel() > 0) ? State::CLEANING : State::EXPLORE;
-            return nextStep();
         }
+    }
 
-        case State::CLEANING: {
-            prev_state = curr_state;
-            std::pair<int, int> dock = {docking_station.r, docking_station.c};
-            auto path = explorer_.getShortestPath_A(sensors_->getCurrentPosition(), dock, false);
-            if (path.size() >= sensors_->getBatteryState() - 2) {
-                curr_state = State::TO_DOCK;
-                if (sensors_->dirtLevel() > 0) {
-                    last_dirty_pos_ = sensors_->getCurrentPosition();
-                } else last_dirty_pos_ = {-20, -20};
-                Step s = Step(path.top());
-                path.pop();
-                steps_counter++;
-                return s;
-            }
-            if (sensors_->dirtLevel() == 0) {
-                curr_state = State::EXPLORE;
-                return nextStep();
-            }
-            explorer_.updateDirtAndClean(curr_pos, sensors_->dirtLevel());
-            steps_counter++;
-            return Step::Stay;
+    // If BFS queue is empty and there are unexplored areas, go to the closest one
+    if (bfs_queue.empty() && !explorer_.areAllAreasExplored()) {
+        int distance;
+        Position pos = closestUnexploredArea(curr_pos, distance);
+        last_dirty_pos_ = {pos.r, pos.c};
+        curr_state = State::TO_POS;
+        return std::nullopt;  // Immediately proceed to TO_POS logic
+    } else if (bfs_queue.empty()) {
+        // If BFS queue is empty and all areas are explored, go back to the dock
+        curr_state = State::TO_DOCK;
+        return std::nullopt;
+    }
+
+    return Step::Stay;
+}
+
+std::optional<Step> Algorithm_212346076_207177197_B::handleToDock(const Position& curr_pos) {
+    prev_state = curr_state;
+    explorer_.setDistance(curr_pos, getMinDistanceOfNeighbors(curr_pos));
+    if (!planToDock(curr_pos).empty()) {
+        steps_counter++;
+        return Step(dock_plan_.next());
+    }
+    if (explorer_.isDockingStation(curr_pos)) {
+        curr_state = State::CHARGING;
+        steps_counter++;
+        return Step::Stay;
+    }
+    return Step::Stay;
+}
+
+std::optional<Step> Algorithm_212346076_207177197_B::handleToPos(const Position& curr_pos) {
+    prev_state = curr_state;
+    if (last_dirty_pos_ == std::make_pair(-20, -20)) {
+        if (explorer_.explored(curr_pos)) {
+            explorer_.updatePlan(pos_plan_, {curr_pos.r, curr_pos.c}, last_dirty_pos_, true);
+        } else{
+            curr_state = State::EXPLORE;
+            return std::nullopt;
         }
+    }else {
+        explorer_.updatePlan(pos_plan_, {curr_pos.r, curr_pos.c}, last_dirty_pos_, false);
+    }
+    if (pos_plan_.size() >= snapshot_->battery-2) {
+        curr_state = State::TO_DOCK;
+        return std::nullopt;
+    }
+    if (!pos_plan_.empty()) {
+        steps_counter++;
+        return Step(pos_plan_.next());
+    }
+    curr_state = (snapshot_->dirt > 0) ? State::CLEANING : State::EXPLORE;
+    return std::nullopt;
+}
 
-        case State::CHARGING: {
-            prev_state = curr_state;
-            if (sensors_->getBatteryState() == sensors_->getMaxBattery()) {
-                curr_state = State::TO_POS;
-                return nextStep();
-            }
+std::optional<Step> Algorithm_212346076_207177197_B::handleCleaning(const Position& curr_pos) {
+    prev_state = curr_state;
+    if (planToDock(curr_pos).size() >= snapshot_->battery - 2) {
+        curr_state = State::TO_DOCK;
+        if (snapshot_->dirt > 0) {
+            last_dirty_pos_ = {curr_pos.r, curr_pos.c};
+        } else last_dirty_pos_ = {-20, -20};
+        if (dock_plan_.empty()) {
+            // Already at the docking station, nothing to walk back
             steps_counter++;
             return Step::Stay;
         }
+        steps_counter++;
+        return Step(dock_plan_.next());
+    }
+    if (snapshot_->dirt == 0) {
+        curr_state = State::EXPLORE;
+        return std::nullopt;
+    }
+    explorer_.updateDirtAndClean(curr_pos, snapshot_->dirt);
+    steps_counter++;
+    return Step::Stay;
+}
 
-        case State::FINISH: {
-            break;
-        }
+std::optional<Step> Algorithm_212346076_207177197_B::handleCharging(const Position&) {
+    prev_state = curr_state;
+    if (snapshot_->battery == max_battery_) {
+        curr_state = State::TO_POS;
+        return std::nullopt;
     }
-    return Step::Stay;  // Default fallback
+    steps_counter++;
+    return Step::Stay;
+}
+
+std::optional<Step> Algorithm_212346076_207177197_B::handleFinish(const Position&) {
+    return Step::Stay;
 }
 
 extern "C" {
@@ -3,13 +3,19 @@
 
 #include "../simulator/Explorer.h"
 #include "../common/AbstractAlgorithm.h"
-#include "../common/SensorImpl.h"
+#include "../common/ResettableAlgorithm.h"
+#include "../common/AllocatorAwareAlgorithm.h"
+#include "../common/SnapshotAlgorithm.h"
+#include "../common/SensorFeed.h"
 #include "../common/states.h"
+#include <array>
 #include <climits>
 #include <iostream>
+#include <optional>
 #include <queue>
 
-class Algorithm_212346076_207177197_B : public AbstractAlgorithm {
+class Algorithm_212346076_207177197_B : public AbstractAlgorithm, public ResettableAlgorithm,
+                                        public AllocatorAwareAlgorithm, public SnapshotAlgorithm {
 public:
     Algorithm_212346076_207177197_B();
     virtual ~Algorithm_212346076_207177197_B() = default;
@@ -18,21 +24,55 @@ public:
     void setDirtSensor(const DirtSensor &) override;
     void setBatteryMeter(const BatteryMeter &) override;
     Step nextStep() override;
+    void reset() override;
+    void setMemoryResource(std::pmr::memory_resource *resource) override;
     bool StateChanged() const;
     State getCurrentState() const;
-    void setSensors(SensorImpl &sensors);
+    void setSensorSnapshot(const SensorSnapshot &snapshot, std::size_t maxBattery) override;
 
 private:
+    void startAt(const Position& dock);
+    Step decideStep();
+
     int max_steps_;
     int steps_counter = 0;
-    SensorImpl* sensors_;
+    SensorFeed sensors_;
+    const SensorSnapshot* snapshot_; // this step's readings, from sensors_
+    std::size_t max_battery_ = 0;
     std::queue<Position> bfs_queue;
     Explorer explorer_;
+    PathPlan dock_plan_; // kept across steps, replanned by explorer_ only when needed
+    PathPlan pos_plan_;
     State prev_state;
     State curr_state;
     Position docking_station = {0, 0};
     std::pair<int,int> last_dirty_pos_ = {-20, -20};
 
+    // Search results for the current step, each valid while the explorer's map version is unchanged
+    struct StepQueries {
+        std::size_t dock_plan_version = SIZE_MAX;
+        std::size_t closest_unexplored_version = SIZE_MAX;
+        Position closest_unexplored = {-20, -20};
+        int closest_unexplored_distance = -1;
+    };
+    StepQueries queries_;
+
+    // One handler per State, indexed by it. A handler returns the step to take, or nothing after changing
+    // curr_state, in which case the handler of the new state runs within the same step.
+    using StateHandler = std::optional<Step> (Algorithm_212346076_207177197_B::*)(const Position& curr_pos);
+    static const std::array<StateHandler, kStateCount> kStateHandlers;
+    // A step passes through a few states at most; the bound only guards against a transition cycle
+    static constexpr int kMaxTransitions = 8;
+
+    const PathPlan& planToDock(const Position& curr_pos);
+    Position closestUnexploredArea(const Position& curr_pos, int& distance);
+    std::optional<Step> handleExplore(const Position& curr_pos);
+    std::optional<Step> handleToDock(const Position& curr_pos);
+    std::optional<Step> handleToPos(const Position& curr_pos);
+    std::optional<Step> handleCleaning(const Position& curr_pos);
+    std::optional<Step> handleCharging(const Position& curr_pos);
+    std::optional<Step> handleFinish(const Position& curr_pos);
+
     void updateExplorerInfo(Position current_position_);
     int getMinDistanceOfNeighbors(const Position& curr_pos);
     void updatePosition(Step stepDirection, Position& curr_pos);
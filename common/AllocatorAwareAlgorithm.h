@@ -0,0 +1,17 @@
+#ifndef ROBOT_ALLOCATOR_AWARE_ALGORITHM_H__
+#define ROBOT_ALLOCATOR_AWARE_ALGORITHM_H__
+
+#include <memory_resource>
+
+// Optional extension of AbstractAlgorithm for algorithms that can keep their state of a run in memory the
+// simulator provides. Before the setters of each run, on a new or reset instance, the simulator passes the
+// memory resource of the worker thread running it. The resource lives as long as the worker, and an instance is
+// only ever reused on the worker it ran on, so a reset instance gets the same resource again: reset() (see
+// ResettableAlgorithm) may clear the state in place and keep the memory for the next run.
+class AllocatorAwareAlgorithm {
+public:
+    virtual ~AllocatorAwareAlgorithm() = default;
+    virtual void setMemoryResource(std::pmr::memory_resource *resource) = 0;
+};
+
+#endif  // ROBOT_ALLOCATOR_AWARE_ALGORITHM_H__
@@ -0,0 +1,36 @@
+#ifndef ROBOT_BATCHED_ALGORITHM_H__
+#define ROBOT_BATCHED_ALGORITHM_H__
+
+#include <cstddef>
+#include <span>
+
+#include "enums.h"
+
+// Conditions checked by the simulator after every step of a batch; the batch ends early when one holds
+enum class BatchTrigger : unsigned {
+    None = 0,
+    Dirt = 1,        // the robot is on a dirty cell
+    BatteryFull = 2, // the battery is fully charged
+};
+
+inline BatchTrigger operator|(BatchTrigger a, BatchTrigger b) {
+    return static_cast<BatchTrigger>(static_cast<unsigned>(a) | static_cast<unsigned>(b));
+}
+
+inline bool hasTrigger(BatchTrigger triggers, BatchTrigger trigger) {
+    return (static_cast<unsigned>(triggers) & static_cast<unsigned>(trigger)) != 0;
+}
+
+// Optional extension of AbstractAlgorithm for algorithms that already know several of their next steps,
+// e.g. the way back to the docking station over explored floor or a run of charging steps.
+// Before each nextStep() the simulator asks for a batch; it applies the steps in order until the batch ends,
+// a trigger holds or the run is over, and reports how many it applied. An empty batch means "call nextStep()".
+class BatchedAlgorithm {
+public:
+    virtual ~BatchedAlgorithm() = default;
+    // The steps stay owned by the algorithm and must remain valid until stepsConsumed() is called
+    virtual std::span<const Step> nextSteps(BatchTrigger &triggers) = 0;
+    virtual void stepsConsumed(std::size_t count) = 0;
+};
+
+#endif  // ROBOT_BATCHED_ALGORITHM_H__
@@ -0,0 +1,222 @@
+#include "BitBfs.h"
+#include <bit>
+#include <limits>
+#include <utility>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+BitGrid::BitGrid(int rows, int cols)
+        : rows_(rows), cols_(cols), words_(((cols + 63) / 64 + 3) / 4 * 4), stride_(words_ + 2),
+          bits_((rows + 2) * stride_, 0) {
+}
+
+bool BitGrid::test(int r, int c) const {
+    if (r < 0 || r >= rows_ || c < 0 || c >= cols_) {
+        return false;
+    }
+    return (row(r)[c / 64] >> (c % 64)) & 1;
+}
+
+void BitGrid::set(int r, int c, bool value) {
+    if (r < 0 || r >= rows_ || c < 0 || c >= cols_) {
+        return;
+    }
+    std::uint64_t bit = std::uint64_t(1) << (c % 64);
+    if (value) {
+        row(r)[c / 64] |= bit;
+    } else {
+        row(r)[c / 64] &= ~bit;
+    }
+}
+
+std::size_t BitGrid::count() const {
+    std::size_t total = 0;
+    for (auto word : bits_) {
+        total += std::popcount(word);
+    }
+    return total;
+}
+
+namespace {
+
+// Kogge-Stone occluded fill: grow gen towards higher bits through the cells set in open
+std::uint64_t fillUp(std::uint64_t gen, std::uint64_t open) {
+    gen |= open & (gen << 1);  open &= open << 1;
+    gen |= open & (gen << 2);  open &= open << 2;
+    gen |= open & (gen << 4);  open &= open << 4;
+    gen |= open & (gen << 8);  open &= open << 8;
+    gen |= open & (gen << 16); open &= open << 16;
+    gen |= open & (gen << 32);
+    return gen;
+}
+
+// Kogge-Stone occluded fill: grow gen towards lower bits through the cells set in open
+std::uint64_t fillDown(std::uint64_t gen, std::uint64_t open) {
+    gen |= open & (gen >> 1);  open &= open >> 1;
+    gen |= open & (gen >> 2);  open &= open >> 2;
+    gen |= open & (gen >> 4);  open &= open >> 4;
+    gen |= open & (gen >> 8);  open &= open >> 8;
+    gen |= open & (gen >> 16); open &= open >> 16;
+    gen |= open & (gen >> 32);
+    return gen;
+}
+
+#if defined(__AVX2__)
+// fillUp/fillDown on four words at once, without carrying between them
+__m256i fillUp4(__m256i gen, __m256i open) {
+    for (int shift = 1; shift < 64; shift *= 2) {
+        gen = _mm256_or_si256(gen, _mm256_and_si256(open, _mm256_sll_epi64(gen, _mm_cvtsi32_si128(shift))));
+        open = _mm256_and_si256(open, _mm256_sll_epi64(open, _mm_cvtsi32_si128(shift)));
+    }
+    return gen;
+}
+
+__m256i fillDown4(__m256i gen, __m256i open) {
+    for (int shift = 1; shift < 64; shift *= 2) {
+        gen = _mm256_or_si256(gen, _mm256_and_si256(open, _mm256_srl_epi64(gen, _mm_cvtsi32_si128(shift))));
+        open = _mm256_and_si256(open, _mm256_srl_epi64(open, _mm_cvtsi32_si128(shift)));
+    }
+    return gen;
+}
+#endif
+
+// Grow the cells of row across every horizontal run of open cells they touch. Each word is filled on its own
+// first, then the runs that cross word boundaries are completed in one pass each way.
+void fillRow(const std::uint64_t *open, std::uint64_t *row, std::size_t words) {
+    std::size_t w = 0;
+#if defined(__AVX2__)
+    for (; w + 4 <= words; w += 4) {
+        __m256i gen = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + w));
+        __m256i mask = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(open + w));
+        gen = fillDown4(fillUp4(gen, mask), mask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(row + w), gen);
+    }
+#endif
+    for (; w < words; ++w) {
+        row[w] = fillDown(fillUp(row[w], open[w]), open[w]);
+    }
+    std::uint64_t carry = 0;
+    for (w = 0; w < words; ++w) {
+        if (carry & open[w] & ~row[w]) {
+            row[w] = fillUp(row[w] | 1, open[w]);
+        }
+        carry = row[w] >> 63;
+    }
+    carry = 0;
+    for (w = words; w-- > 0;) {
+        if ((carry << 63) & open[w] & ~row[w]) {
+            row[w] = fillDown(row[w] | (std::uint64_t(1) << 63), open[w]);
+        }
+        carry = row[w] & 1;
+    }
+}
+
+// Add to row the cells of the neighbouring row that are open in this row, then fill horizontally.
+// Returns true if row changed.
+bool sweepRow(const std::uint64_t *open, const std::uint64_t *neighbour, std::uint64_t *row, std::size_t words) {
+    std::uint64_t incoming = 0;
+    std::size_t w = 0;
+#if defined(__AVX2__)
+    __m256i incomingVec = _mm256_setzero_si256();
+    for (; w + 4 <= words; w += 4) {
+        __m256i curr = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + w));
+        __m256i added = _mm256_andnot_si256(curr, _mm256_and_si256(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(neighbour + w)),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(open + w))));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(row + w), _mm256_or_si256(curr, added));
+        incomingVec = _mm256_or_si256(incomingVec, added);
+    }
+    incoming = !_mm256_testz_si256(incomingVec, incomingVec);
+#endif
+    for (; w < words; ++w) {
+        std::uint64_t added = neighbour[w] & open[w] & ~row[w];
+        row[w] |= added;
+        incoming |= added;
+    }
+    if (incoming == 0) {
+        return false;
+    }
+    fillRow(open, row, words);
+    return true;
+}
+
+}
+
+// One level at a time with a plain queue: expanding the wavefront with shifts and masks was slower, since the
+// front of an open room only touches a couple of words per row and every cell still needs its own distance.
+// Cells are tested on the packed rows, whose zero padding stands for the border above, below and to the right.
+DistanceSearch::DistanceSearch(const BitGrid &passable, Position src)
+        : passable_(&passable), distances_(static_cast<std::size_t>(passable.getRows()) * passable.getCols(), -1) {
+    if (passable.test(src.r, src.c)) {
+        distances_[static_cast<std::size_t>(src.r) * passable.getCols() + src.c] = 0;
+        frontier_.push_back(src);
+    }
+}
+
+bool DistanceSearch::expand(std::size_t limit) {
+    const int cols = passable_ ? passable_->getCols() : 0;
+    auto open = [](const std::uint64_t *row, int c) { return ((row[c / 64] >> (c % 64)) & 1) != 0; };
+    for (; limit > 0 && !frontier_.empty(); --limit) {
+        if (index_ == frontier_.size()) {
+            std::swap(frontier_, next_);
+            next_.clear();
+            index_ = 0;
+            ++level_;
+            continue;
+        }
+        const Position pos = frontier_[index_++];
+        int *cell = distances_.data() + static_cast<std::size_t>(pos.r) * cols + pos.c;
+        auto visit = [&](int *neighbour, Position neighbourPos) {
+            if (*neighbour < 0) {
+                *neighbour = level_;
+                next_.push_back(neighbourPos);
+            }
+        };
+        const std::uint64_t *row = passable_->row(pos.r);
+        if (open(passable_->row(pos.r - 1), pos.c)) {
+            visit(cell - cols, {pos.r - 1, pos.c});
+        }
+        if (open(passable_->row(pos.r + 1), pos.c)) {
+            visit(cell + cols, {pos.r + 1, pos.c});
+        }
+        if (open(row, pos.c + 1)) {
+            visit(cell + 1, {pos.r, pos.c + 1});
+        }
+        if (pos.c > 0 && open(row, pos.c - 1)) {
+            visit(cell - 1, {pos.r, pos.c - 1});
+        }
+    }
+    return isDone();
+}
+
+std::vector<int> BitBfs::distanceField(const BitGrid &passable, Position src) {
+    DistanceSearch search(passable, src);
+    search.expand(std::numeric_limits<std::size_t>::max());
+    return search.takeDistances();
+}
+
+// Reachability does not need levels, so whole rows are flooded at once: every row is filled along its runs of
+// passable cells and pushed into the row below, then the same is done upwards, until nothing changes.
+BitGrid BitBfs::reachable(const BitGrid &passable, Position src) {
+    const int rows = passable.getRows();
+    const std::size_t words = passable.getWordsPerRow();
+    BitGrid visited(rows, passable.getCols());
+    if (!passable.test(src.r, src.c)) {
+        return visited;
+    }
+    visited.set(src.r, src.c);
+    fillRow(passable.row(src.r), visited.row(src.r), words);
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int r = 1; r < rows; ++r) {
+            changed |= sweepRow(passable.row(r), visited.row(r - 1), visited.row(r), words);
+        }
+        for (int r = rows - 2; r >= 0; --r) {
+            changed |= sweepRow(passable.row(r), visited.row(r + 1), visited.row(r), words);
+        }
+    }
+    return visited;
+}
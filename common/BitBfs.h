@@ -0,0 +1,72 @@
+#ifndef VACUUM_FINAL_BITBFS_H
+#define VACUUM_FINAL_BITBFS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "states.h"
+#include "PlannerApi.h"
+
+// A rows x cols grid with one bit per cell, stored as rows of 64-bit words.
+// Every row has a zero word before and after it, and there is a zero row above and below the grid,
+// so neighbouring words can always be read without bounds checks.
+class PLANNER_API BitGrid {
+public:
+    BitGrid() = default;
+    BitGrid(int rows, int cols);
+
+    int getRows() const { return rows_; }
+    int getCols() const { return cols_; }
+    std::size_t getWordsPerRow() const { return words_; }
+    std::size_t getStride() const { return stride_; }
+
+    bool test(int r, int c) const;
+    void set(int r, int c, bool value = true);
+    std::size_t count() const;
+
+    // Words of row r; r may be -1 or rows for the zero padding rows
+    std::uint64_t *row(int r) { return bits_.data() + (r + 1) * stride_ + 1; }
+    const std::uint64_t *row(int r) const { return bits_.data() + (r + 1) * stride_ + 1; }
+
+private:
+    int rows_ = 0;
+    int cols_ = 0;
+    std::size_t words_ = 0;  // words holding cells in each row, rounded up to a multiple of 4
+    std::size_t stride_ = 0; // words between the starts of two consecutive rows, padding included
+    std::vector<std::uint64_t> bits_;
+};
+
+// Distances from one cell, computed a bounded number of cells at a time so a long search can be spread over
+// several calls. The grid must outlive the search.
+class PLANNER_API DistanceSearch {
+public:
+    DistanceSearch() = default;
+    DistanceSearch(const BitGrid &passable, Position src);
+
+    // Settle up to limit more cells. Returns true once every reachable cell has its distance.
+    bool expand(std::size_t limit);
+    bool isDone() const { return frontier_.empty(); }
+    // Distance to every cell, -1 for cells that are not passable or not reached yet
+    std::vector<int> takeDistances() { return std::move(distances_); }
+
+private:
+    const BitGrid *passable_ = nullptr;
+    std::vector<int> distances_;
+    std::vector<Position> frontier_; // cells at distance level_ - 1
+    std::vector<Position> next_;     // cells at distance level_
+    std::size_t index_ = 0;          // first cell of frontier_ not expanded yet
+    int level_ = 1;
+};
+
+// Breadth-first search over packed rows. Reachability floods whole rows at once with shifts and masks and uses
+// AVX2 when the build enables it (VACUUM_ENABLE_AVX2); distance fields go level by level with a queue.
+class PLANNER_API BitBfs {
+public:
+    // Distance from src to every cell, -1 for cells that are not passable or not reachable
+    static std::vector<int> distanceField(const BitGrid &passable, Position src);
+    // Cells reachable from src
+    static BitGrid reachable(const BitGrid &passable, Position src);
+};
+
+#endif //VACUUM_FINAL_BITBFS_H
@@ -0,0 +1,13 @@
+#ifndef VACUUM_FINAL_PLANNERAPI_H
+#define VACUUM_FINAL_PLANNERAPI_H
+
+// The planner core (Explorer, DStarLite, PositionUtils, the BFS kernels, House and SensorImpl) is built once as
+// the PlannerCore shared library that the simulator and every algorithm plugin link against.
+// It is compiled with hidden visibility; only what is marked PLANNER_API is part of its ABI.
+#if defined(__GNUC__) || defined(__clang__)
+#define PLANNER_API __attribute__((visibility("default")))
+#else
+#define PLANNER_API
+#endif
+
+#endif //VACUUM_FINAL_PLANNERAPI_H
@@ -80,6 +80,9 @@ std::ostream &operator<<(std::ostream &out, const State &state) {
         case State::CLEANING:
             out << "CLEANING";
             break;
+        case State::TOUR:
+            out << "TOUR";
+            break;
         default:
             out << "UNKNOWN_STATE";
     }
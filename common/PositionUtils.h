@@ -8,10 +8,11 @@
 
 #include "../common/states.h"
 #include "../common/enums.h"
+#include "PlannerApi.h"
 #include <iostream>
 #include <vector>
 
-class PositionUtils {
+class PLANNER_API PositionUtils {
 public:
     static Position toOffset(Direction dir, bool reverse = false);
     static Direction fromOffset(int x, int y);
@@ -0,0 +1,15 @@
+#ifndef ROBOT_RESETTABLE_ALGORITHM_H__
+#define ROBOT_RESETTABLE_ALGORITHM_H__
+
+// Optional extension of AbstractAlgorithm for algorithms that can be reused for another run.
+// The simulator keeps such an instance per worker thread; after a run it calls reset(), and the next run of the
+// same algorithm on that thread gets the instance back and calls the setters as it does on a new one.
+// After reset() the algorithm must behave exactly like a newly constructed one, but it may keep the memory it
+// already allocated (maps, queues, buffers).
+class ResettableAlgorithm {
+public:
+    virtual ~ResettableAlgorithm() = default;
+    virtual void reset() = 0;
+};
+
+#endif  // ROBOT_RESETTABLE_ALGORITHM_H__
@@ -0,0 +1,76 @@
+#ifndef ROBOT_SENSOR_FEED_H__
+#define ROBOT_SENSOR_FEED_H__
+
+#include <cstddef>
+
+#include "BatteryMeter.h"
+#include "DirtSensor.h"
+#include "PositionUtils.h"
+#include "SensorSnapshot.h"
+#include "WallSensor.h"
+#include "enums.h"
+
+// Sensor readings of an algorithm that implements SnapshotAlgorithm. A simulator that knows the extension delivers
+// a snapshot; other hosts only call the standard setters, and then a local snapshot is filled from WallsSensor,
+// DirtSensor and BatteryMeter on every step. Those interfaces do not report the position, so it is followed from
+// the steps the algorithm takes, starting at kTrackedDock.
+class SensorFeed {
+public:
+    // Where the docking station is without a snapshot; any origin works, this one stays clear of the {-20, -20}
+    // the algorithms use for "no position"
+    static constexpr Position kTrackedDock = {1 << 20, 1 << 20};
+
+    void setWallsSensor(const WallsSensor &sensor) { walls_ = &sensor; }
+    void setDirtSensor(const DirtSensor &sensor) { dirt_ = &sensor; }
+    void setBatteryMeter(const BatteryMeter &meter) { battery_ = &meter; }
+    void setSnapshot(const SensorSnapshot &snapshot, std::size_t maxBattery) {
+        delivered_ = &snapshot;
+        max_battery_ = maxBattery;
+    }
+    bool hasSnapshot() const { return delivered_ != nullptr; }
+
+    // Readings for the current step, or nullptr if neither a snapshot nor all three sensors were given
+    const SensorSnapshot *read() {
+        if (delivered_) {
+            return delivered_;
+        }
+        if (!walls_ || !dirt_ || !battery_) {
+            return nullptr;
+        }
+        local_.walls = 0;
+        for (int d = 0; d < 4; ++d) {
+            if (walls_->isWall(static_cast<Direction>(d))) {
+                local_.walls |= static_cast<std::uint8_t>(1u << d);
+            }
+        }
+        local_.dirt = dirt_->dirtLevel();
+        local_.battery = battery_->getBatteryState();
+        local_.position = position_;
+        if (max_battery_ == 0) {
+            max_battery_ = local_.battery; // the robot starts charged
+        }
+        return &local_;
+    }
+
+    // The battery capacity; without a snapshot, the battery at the first reading
+    std::size_t getMaxBattery() const { return max_battery_; }
+
+    // Record a step the algorithm returned, so the position can be followed without a snapshot
+    Step taken(Step step) {
+        if (!delivered_ && step != Step::Stay && step != Step::Finish) {
+            position_ = PositionUtils::movePosition(position_, static_cast<Direction>(step));
+        }
+        return step;
+    }
+
+private:
+    const SensorSnapshot *delivered_ = nullptr;
+    const WallsSensor *walls_ = nullptr;
+    const DirtSensor *dirt_ = nullptr;
+    const BatteryMeter *battery_ = nullptr;
+    SensorSnapshot local_;
+    Position position_ = kTrackedDock;
+    std::size_t max_battery_ = 0;
+};
+
+#endif  // ROBOT_SENSOR_FEED_H__
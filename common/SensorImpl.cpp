@@ -9,6 +9,15 @@ SensorImpl::SensorImpl(const House& house, int maxBattery)
         : house(house), currentRow(0), currentCol(0), batteryLevel(maxBattery), maxBattery(maxBattery) {
     currentCol = house.getDockingStation().c;
     currentRow = house.getDockingStation().r;
+    refreshSnapshot();
+}
+
+void SensorImpl::refreshSnapshot() {
+    Position pos = {currentRow, currentCol};
+    snapshot_.walls = house.getWallMask(pos);
+    snapshot_.dirt = house.getDirtLevel(pos);
+    snapshot_.battery = getBatteryState();
+    snapshot_.position = pos;
 }
 
 
@@ -52,7 +61,9 @@ std::pair<int,int> SensorImpl::getCurrentPosition() const {
 
 void SensorImpl::useBattery() {
     batteryLevel--;
-    std::cout << "Battery level: " << batteryLevel << std::endl;
+    if (!quiet) {
+        std::cout << "Battery level: " << batteryLevel << std::endl;
+    }
 }
 
 std::size_t SensorImpl::getMaxBattery() const {
@@ -10,8 +10,10 @@
 #include "BatteryMeter.h"
 #include "House.h"
 #include "enums.h"
+#include "SensorSnapshot.h"
+#include "PlannerApi.h"
 
-class SensorImpl : public WallsSensor, public DirtSensor, public BatteryMeter {
+class PLANNER_API SensorImpl : public WallsSensor, public DirtSensor, public BatteryMeter {
 public:
     SensorImpl(const House& house, int maxBattery);
 
@@ -33,6 +35,12 @@ public:
     void useBattery();
     std::size_t getMaxBattery() const;
     void chargeBattery();
+    // Do not log every battery change
+    void setQuiet(bool enabled) { quiet = enabled; }
+
+    // Recompute the snapshot from the house; the simulator calls this once per step
+    void refreshSnapshot();
+    const SensorSnapshot& snapshot() const { return snapshot_; }
 
 private:
     const House& house;
@@ -40,6 +48,8 @@ private:
     int currentCol;
     float batteryLevel;
     int maxBattery;
+    SensorSnapshot snapshot_;
+    bool quiet = false;
 };
 
 #endif //VACUUM_FINAL_SENSORIMPL_H
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef VACUUM_FINAL_SENSORSNAPSHOT_H
+#define VACUUM_FINAL_SENSORSNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include "states.h"
+#include "enums.h"
+
+// Everything the sensors report for the current step, filled once per step by the simulator so that
+// algorithms can read it without virtual calls
+struct SensorSnapshot {
+    std::uint8_t walls = 0; // bit i set if there is a wall in Direction(i)
+    int dirt = 0;           // as DirtSensor::dirtLevel()
+    std::size_t battery = 0;
+    Position position = {0, 0};
+
+    bool isWall(Direction d) const {
+        return (walls >> static_cast<int>(d)) & 1;
+    }
+};
+
+#endif //VACUUM_FINAL_SENSORSNAPSHOT_H
@@ -0,0 +1,17 @@
+#ifndef ROBOT_SNAPSHOT_ALGORITHM_H__
+#define ROBOT_SNAPSHOT_ALGORITHM_H__
+
+#include <cstddef>
+
+#include "SensorSnapshot.h"
+
+// Optional extension of AbstractAlgorithm for algorithms that read their sensors from a SensorSnapshot instead
+// of the WallsSensor, DirtSensor and BatteryMeter interfaces. After the setters of each run the simulator passes
+// the snapshot it refreshes after every step, which stays valid until the run is over, and the battery capacity.
+class SnapshotAlgorithm {
+public:
+    virtual ~SnapshotAlgorithm() = default;
+    virtual void setSensorSnapshot(const SensorSnapshot &snapshot, std::size_t maxBattery) = 0;
+};
+
+#endif  // ROBOT_SNAPSHOT_ALGORITHM_H__
@@ -4,6 +4,7 @@
 
 #ifndef VACUUM_FINAL_STATES_H
 #define VACUUM_FINAL_STATES_H
+#include <cstddef>
 #include <vector>
 #include <iostream>
 
@@ -45,8 +46,11 @@ enum class State {
     TO_POS, // backtracking
     FINISH,
     EXPLORE,
-    CLEANING
+    CLEANING,
+    TOUR // following a planned cleaning trip
 };
+// Number of states, for tables indexed by State
+constexpr std::size_t kStateCount = static_cast<std::size_t>(State::TOUR) + 1;
 
 #define MAXIMUM_DIRT 9
 enum class LocType {
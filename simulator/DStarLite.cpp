@@ -0,0 +1,200 @@
+#include "DStarLite.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+constexpr Direction kDirections[4] = {Direction::North, Direction::East, Direction::South, Direction::West};
+}
+
+DStarLite::DStarLite(const Explorer &explorer)
+    : explorer_(explorer), g_(explorer.getMemoryResource()), rhs_(explorer.getMemoryResource()),
+      open_(explorer.getMemoryResource()), open_keys_(explorer.getMemoryResource()) {
+}
+
+void DStarLite::setGoal(const Position &goal) {
+    clearGoal();
+    goal_ = goal;
+    changes_seen_ = explorer_.getMapChanges().size();
+    rhs_[goal_] = 0;
+    Key key = {heuristic(start_, goal_), 0};
+    open_.insert({key, goal_});
+    open_keys_[goal_] = key;
+}
+
+void DStarLite::clearGoal() {
+    goal_ = {-20, -20};
+    start_ = last_start_ = {-20, -20};
+    km_ = 0;
+    std::pmr::memory_resource *resource = explorer_.getMemoryResource();
+    if (!resource->is_equal(*g_.get_allocator().resource())) {
+        rebuildOnResource(g_, resource);
+        rebuildOnResource(rhs_, resource);
+        rebuildOnResource(open_, resource);
+        rebuildOnResource(open_keys_, resource);
+        return;
+    }
+    g_.clear();
+    rhs_.clear();
+    open_.clear();
+    open_keys_.clear();
+}
+
+bool DStarLite::hasGoal() const {
+    return goal_.r != -20;
+}
+
+Position DStarLite::getGoal() const {
+    return goal_;
+}
+
+int DStarLite::update(const Position &start) {
+    if (!hasGoal()) {
+        return -1;
+    }
+    if (last_start_.r == -20) {
+        last_start_ = start;
+    }
+    // Keys already in the queue were computed against the old start; raising km keeps them lower bounds
+    start_ = start;
+    km_ += heuristic(last_start_, start_);
+    last_start_ = start_;
+
+    // A changed cell affects its own rhs and the rhs of the four cells next to it
+    const auto &changes = explorer_.getMapChanges();
+    for (; changes_seen_ < changes.size(); ++changes_seen_) {
+        Position pos = changes[changes_seen_];
+        updateVertex(pos);
+        for (Direction dir : kDirections) {
+            updateVertex(PositionUtils::movePosition(pos, dir));
+        }
+    }
+    computeShortestPath();
+    int distance = getG(start_);
+    return distance >= kInfinity ? -1 : distance;
+}
+
+bool DStarLite::nextMove(Direction &dir) const {
+    int best = kInfinity;
+    for (Direction candidate : kDirections) {
+        Position pos = PositionUtils::movePosition(start_, candidate);
+        if (traversable(pos) && getG(pos) + 1 < best) {
+            best = getG(pos) + 1;
+            dir = candidate;
+        }
+    }
+    return best < kInfinity;
+}
+
+std::vector<Direction> DStarLite::getPath() const {
+    std::vector<Direction> path;
+    int distance = getG(start_);
+    if (distance >= kInfinity) {
+        return path;
+    }
+    // Walk down the distances: every step has a neighbour exactly one closer to the goal
+    Position pos = start_;
+    for (int remaining = distance; remaining > 0; --remaining) {
+        bool moved = false;
+        for (Direction dir : kDirections) {
+            Position next = PositionUtils::movePosition(pos, dir);
+            if (traversable(next) && getG(next) == remaining - 1) {
+                path.push_back(dir);
+                pos = next;
+                moved = true;
+                break;
+            }
+        }
+        if (!moved) {
+            break;
+        }
+    }
+    return path;
+}
+
+std::size_t DStarLite::getLastExpansions() const {
+    return last_expansions_;
+}
+
+bool DStarLite::traversable(const Position &pos) const {
+    return pos == goal_ || explorer_.isKnownFloor(pos);
+}
+
+int DStarLite::getG(const Position &pos) const {
+    auto it = g_.find(pos);
+    return it == g_.end() ? kInfinity : it->second;
+}
+
+int DStarLite::getRhs(const Position &pos) const {
+    auto it = rhs_.find(pos);
+    return it == rhs_.end() ? kInfinity : it->second;
+}
+
+int DStarLite::heuristic(const Position &a, const Position &b) const {
+    if (a.r == -20 || b.r == -20) {
+        return 0;
+    }
+    return std::abs(a.r - b.r) + std::abs(a.c - b.c);
+}
+
+DStarLite::Key DStarLite::calculateKey(const Position &pos) const {
+    int best = std::min(getG(pos), getRhs(pos));
+    return {best + heuristic(start_, pos) + km_, best};
+}
+
+// Recompute rhs of pos from its neighbours and put it in the queue if it became inconsistent
+void DStarLite::updateVertex(const Position &pos) {
+    if (pos != goal_) {
+        int best = kInfinity;
+        if (traversable(pos)) {
+            for (Direction dir : kDirections) {
+                Position neighbor = PositionUtils::movePosition(pos, dir);
+                if (traversable(neighbor)) {
+                    best = std::min(best, getG(neighbor) + 1);
+                }
+            }
+        }
+        if (best >= kInfinity) {
+            rhs_.erase(pos);
+        } else {
+            rhs_[pos] = best;
+        }
+    }
+    auto it = open_keys_.find(pos);
+    if (it != open_keys_.end()) {
+        open_.erase({it->second, pos});
+        open_keys_.erase(it);
+    }
+    if (getG(pos) != getRhs(pos)) {
+        Key key = calculateKey(pos);
+        open_.insert({key, pos});
+        open_keys_[pos] = key;
+    }
+}
+
+void DStarLite::computeShortestPath() {
+    last_expansions_ = 0;
+    while (!open_.empty() &&
+           (open_.begin()->first < calculateKey(start_) || getRhs(start_) != getG(start_))) {
+        auto [oldKey, pos] = *open_.begin();
+        open_.erase(open_.begin());
+        open_keys_.erase(pos);
+        ++last_expansions_;
+
+        Key newKey = calculateKey(pos);
+        if (oldKey < newKey) {
+            open_.insert({newKey, pos});
+            open_keys_[pos] = newKey;
+        } else if (getG(pos) > getRhs(pos)) {
+            g_[pos] = getRhs(pos);
+            for (Direction dir : kDirections) {
+                updateVertex(PositionUtils::movePosition(pos, dir));
+            }
+        } else {
+            g_.erase(pos);
+            updateVertex(pos);
+            for (Direction dir : kDirections) {
+                updateVertex(PositionUtils::movePosition(pos, dir));
+            }
+        }
+    }
+}
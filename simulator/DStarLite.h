@@ -0,0 +1,63 @@
+#ifndef VACUUM_FINAL_DSTARLITE_H
+#define VACUUM_FINAL_DSTARLITE_H
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+#include <climits>
+#include "Explorer.h"
+#include "../common/PlannerApi.h"
+
+// D* Lite over the explored part of the map. Distances are searched backwards from the goal, so when the robot
+// moves or new cells are explored only the part of the search tree they affect is repaired.
+// The goal itself may be an unexplored area; every other cell on a path is explored floor.
+// The search tree is allocated from the explorer's memory resource, and follows it when a new goal is set or the
+// goal is cleared.
+class PLANNER_API DStarLite {
+public:
+    explicit DStarLite(const Explorer &explorer);
+
+    // Drop the current search tree and start a new one towards goal
+    void setGoal(const Position &goal);
+    void clearGoal();
+    bool hasGoal() const;
+    Position getGoal() const;
+
+    // Catch up with the explorer's map changes and the robot now being at start.
+    // Returns the number of steps from start to the goal, or -1 if it cannot be reached.
+    int update(const Position &start);
+
+    // First move of a shortest path from the start given to the last update()
+    bool nextMove(Direction &dir) const;
+    // All moves of that path, empty if the goal cannot be reached
+    std::vector<Direction> getPath() const;
+
+    std::size_t getLastExpansions() const;
+
+private:
+    using Key = std::pair<int, int>;
+    static constexpr int kInfinity = INT_MAX / 4;
+
+    bool traversable(const Position &pos) const;
+    int getG(const Position &pos) const;
+    int getRhs(const Position &pos) const;
+    int heuristic(const Position &a, const Position &b) const;
+    Key calculateKey(const Position &pos) const;
+    void updateVertex(const Position &pos);
+    void computeShortestPath();
+
+    const Explorer &explorer_;
+    Position goal_ = {-20, -20};
+    Position start_ = {-20, -20};
+    Position last_start_ = {-20, -20};
+    int km_ = 0;
+    std::size_t changes_seen_ = 0; // prefix of explorer_.getMapChanges() already applied
+    std::pmr::map<Position, int> g_;
+    std::pmr::map<Position, int> rhs_;
+    std::pmr::set<std::pair<Key, Position>> open_;
+    std::pmr::map<Position, Key> open_keys_;
+    std::size_t last_expansions_ = 0;
+};
+
+#endif //VACUUM_FINAL_DSTARLITE_H
@@ -2,12 +2,49 @@
 // Created by 97250 on 8/13/2024.
 //
 
+#include <memory>
 #include <queue>
 #include "Explorer.h"
 #include "../common/PositionUtils.h"
 
-Explorer::Explorer(){
-    
+Explorer::Explorer(std::pmr::memory_resource *resource)
+    : mapped_areas_(resource), unexplored_areas_(resource), total_dirt_(0), frontier_buckets_(resource),
+      frontier_dock_distance_(resource), dirty_areas_(resource), discovered_walls_(resource),
+      neighbor_masks_(resource), map_changes_(resource) {
+}
+
+void Explorer::reset(std::pmr::memory_resource *resource) {
+    if (resource->is_equal(*getMemoryResource())) {
+        reset();
+        return;
+    }
+    rebuildOnResource(mapped_areas_, resource);
+    rebuildOnResource(unexplored_areas_, resource);
+    rebuildOnResource(frontier_buckets_, resource);
+    rebuildOnResource(frontier_dock_distance_, resource);
+    rebuildOnResource(dirty_areas_, resource);
+    rebuildOnResource(discovered_walls_, resource);
+    rebuildOnResource(neighbor_masks_, resource);
+    rebuildOnResource(map_changes_, resource);
+    reset();
+}
+
+std::pmr::memory_resource *Explorer::getMemoryResource() const {
+    return mapped_areas_.get_allocator().resource();
+}
+
+void Explorer::reset() {
+    mapped_areas_.clear();
+    unexplored_areas_.clear();
+    total_dirt_ = 0;
+    docking_station_ = {-20, -20};
+    frontier_buckets_.clear();
+    frontier_dock_distance_.clear();
+    dirty_areas_.clear();
+    discovered_walls_.clear();
+    neighbor_masks_.clear();
+    map_version_ = 0;
+    map_changes_.clear();
 }
 
 bool Explorer::explored(const Position pos) const {
@@ -31,7 +68,8 @@ int Explorer::getDistance(const Position pos) {
 
 // Set the distance from the docking station to a specific position
 void Explorer::setDistance(const Position pos, int distance) {
-        mapped_areas_[pos].second = distance;
+    mapped_areas_[pos].second = distance;
+    refreshPassability(pos);
 }
 
 
@@ -43,23 +81,29 @@ void Explorer::setDirtLevel(const Position pos, int dirtLevel) {
 
     mapped_areas_[pos].first = dirtLevel;
     total_dirt_ += (dirtLevel >= 0 && dirtLevel <= MAXIMUM_DIRT) ? dirtLevel : 0;
+    updateDirtyIndex(pos);
+    refreshPassability(pos);
 }
 
 // Check if a position is a wall
 bool Explorer::isWall(const Position pos) {
-    return mapped_areas_[pos].first == static_cast<int>(LocType::Wall);
+    auto it = mapped_areas_.find(pos);
+    return it != mapped_areas_.end() && it->second.first == static_cast<int>(LocType::Wall);
 }
 
 // Check if a position is the docking station
 bool Explorer::isDockingStation(const Position pos) {
-    return mapped_areas_[pos].first == static_cast<int>(LocType::Dock);
+    auto it = mapped_areas_.find(pos);
+    return it != mapped_areas_.end() && it->second.first == static_cast<int>(LocType::Dock);
 }
 
 // Perform cleaning at a specific position
 void Explorer::performCleaning(const Position pos) {
-    if (mapped_areas_[pos].first > 0 && mapped_areas_[pos].first <= MAXIMUM_DIRT) {
-        mapped_areas_[pos].first--;
+    auto it = mapped_areas_.find(pos);
+    if (it != mapped_areas_.end() && it->second.first > 0 && it->second.first <= MAXIMUM_DIRT) {
+        it->second.first--;
         total_dirt_--;
+        updateDirtyIndex(pos);
     }
 }
 
@@ -71,10 +115,21 @@ void Explorer::updateDirtAndClean(const Position pos, int dirtLevel) {
 
     mapped_areas_[pos].first = dirtLevel;
     total_dirt_ += (dirtLevel >= 0 && dirtLevel <= MAXIMUM_DIRT) ? dirtLevel : 0;
+    updateDirtyIndex(pos);
+    refreshPassability(pos);
 
     performCleaning(pos);
 }
 
+// Keep the dirty areas index in sync with the dirt level recorded for a position
+void Explorer::updateDirtyIndex(const Position pos) {
+    if (mapped_areas_[pos].first > 0) {
+        dirty_areas_.insert(pos);
+    } else {
+        dirty_areas_.erase(pos);
+    }
+}
+
 // Check if there are any unexplored areas left
 bool Explorer::areAllAreasExplored() {
     return unexplored_areas_.empty();
@@ -85,10 +140,20 @@ bool Explorer::isAreaUnexplored(const Position pos) {
     return unexplored_areas_.count(pos) != 0;
 }
 
+bool Explorer::isKnownFloor(const Position &pos) const {
+    auto it = mapped_areas_.find(pos);
+    return it != mapped_areas_.end() && it->second.first != static_cast<int>(LocType::Wall) &&
+           unexplored_areas_.count(pos) == 0;
+}
+
 // Remove a position from the unexplored areas
 void Explorer::removeFromUnexplored(const Position pos) {
     if (isAreaUnexplored(pos)) {
         unexplored_areas_.erase(pos);
+        removeFromFrontier(pos);
+        refreshPassability(pos);
+        ++map_version_;
+        map_changes_.push_back(pos);
     }
 }
 
@@ -96,16 +161,118 @@ void Explorer::removeFromUnexplored(const Position pos) {
 void Explorer::updateAdjacentArea(Direction dir, Position position, bool isWall) {
     Position adjacentPosition = PositionUtils::movePosition(position, dir);
     if (isWall) {
+        if (mapped_areas_.count(adjacentPosition) == 0 ||
+            mapped_areas_[adjacentPosition].first != static_cast<int>(LocType::Wall)) {
+            discovered_walls_.push_back(adjacentPosition);
+        }
         mapped_areas_[adjacentPosition].first = static_cast<int>(LocType::Wall);
+        dirty_areas_.erase(adjacentPosition);
+        refreshPassability(adjacentPosition);
     } else {
         if (mapped_areas_.count(adjacentPosition) == 0) {
             unexplored_areas_[adjacentPosition];
+            int distance = getDistance(position);
+            if (distance < 0) {
+                // The neighbour has no known distance yet, fall back to the straight-line estimate
+                distance = docking_station_.r == -20 ? INT_MAX - 1 : manhattanDistance(position, docking_station_);
+            }
+            addToFrontier(adjacentPosition, distance + 1);
+            refreshPassability(adjacentPosition);
         }
     }
 }
 
+int Explorer::manhattanDistance(const Position &a, const Position &b) const {
+    return std::abs(a.r - b.r) + std::abs(a.c - b.c);
+}
+
+BitGrid Explorer::getPassableGrid(DistanceField &field) const {
+    Position low = {INT_MAX, INT_MAX};
+    Position high = {INT_MIN, INT_MIN};
+    auto grow = [&](const Position& pos) {
+        low = {std::min(low.r, pos.r), std::min(low.c, pos.c)};
+        high = {std::max(high.r, pos.r), std::max(high.c, pos.c)};
+    };
+    for (const auto& [pos, _] : unexplored_areas_) {
+        grow(pos);
+    }
+    for (const auto& [pos, area] : mapped_areas_) {
+        if (area.first != static_cast<int>(LocType::Wall)) {
+            grow(pos);
+        }
+    }
+    if (low.r == INT_MAX) {
+        field = DistanceField();
+        return BitGrid();
+    }
+
+    field.origin = low;
+    field.rows = high.r - low.r + 1;
+    field.cols = high.c - low.c + 1;
+    field.distances.clear();
+    BitGrid passable(field.rows, field.cols);
+    for (const auto& [pos, _] : unexplored_areas_) {
+        passable.set(pos.r - low.r, pos.c - low.c);
+    }
+    for (const auto& [pos, area] : mapped_areas_) {
+        if (area.first != static_cast<int>(LocType::Wall)) {
+            passable.set(pos.r - low.r, pos.c - low.c);
+        }
+    }
+    return passable;
+}
+
+// Set the docking station used as the origin of the frontier index
+void Explorer::setDockingStation(const Position pos) {
+    docking_station_ = pos;
+}
+
+// Get the estimated distance from the docking station to an unexplored area, -1 if it is not on the frontier
+int Explorer::getFrontierDockDistance(const Position pos) const {
+    auto it = frontier_dock_distance_.find(pos);
+    return it == frontier_dock_distance_.end() ? -1 : it->second;
+}
+
+// Get the unexplored area closest to the docking station, or {-20, -20} if none is within maxDockDistance
+Position Explorer::getNearestFrontier(int maxDockDistance) const {
+    if (frontier_buckets_.empty() || frontier_buckets_.begin()->first > maxDockDistance) {
+        return {-20, -20};
+    }
+    return *frontier_buckets_.begin()->second.begin();
+}
+
+// Put an unexplored area in its dock distance bucket, keeping the smallest estimate seen so far
+void Explorer::addToFrontier(const Position pos, int dockDistance) {
+    auto it = frontier_dock_distance_.find(pos);
+    if (it != frontier_dock_distance_.end()) {
+        if (it->second <= dockDistance) {
+            return;
+        }
+        removeFromFrontier(pos);
+    }
+    frontier_dock_distance_[pos] = dockDistance;
+    frontier_buckets_[dockDistance].insert(pos);
+}
+
+// Remove an unexplored area from the frontier index
+void Explorer::removeFromFrontier(const Position pos) {
+    auto it = frontier_dock_distance_.find(pos);
+    if (it == frontier_dock_distance_.end()) {
+        return;
+    }
+    auto bucket = frontier_buckets_.find(it->second);
+    bucket->second.erase(pos);
+    if (bucket->second.empty()) {
+        frontier_buckets_.erase(bucket);
+    }
+    frontier_dock_distance_.erase(it);
+}
+
 //function to find the path from src to dst using A* algorithm, or to the closest dirt/unexplored area if search is true
 std::stack<Direction> Explorer::getShortestPath_A(std::pair<int, int> src, std::pair<int, int> dst, bool search) {
+    if (!search && mapped_areas_.size() + unexplored_areas_.size() >= kJumpPointSearchMinCells) {
+        return isOpenMap() ? getShortestPath_JPS(src, dst) : getShortestPath_Bidirectional(src, dst);
+    }
     std::stack<Direction> path;
     std::priority_queue<Position, std::vector<Position>, std::greater<Position>> pq;
     std::map<Position, bool> visited;
@@ -127,8 +294,7 @@ std::stack<Direction> Explorer::getShortestPath_A(std::pair<int, int> src, std::
             break;
         }
 
-        for (const auto& v : getNeighbors({t.r, t.c})) {
-            Position neighbor = {v.first, v.second};
+        forEachNeighbor(t, [&](const Position& neighbor) {
             if (visited.count(neighbor) == 0) {
                 g[neighbor] = g[t] + 1;
                 h[neighbor] = abs(neighbor.r - dst.first) + abs(neighbor.c - dst.second);
@@ -137,9 +303,9 @@ std::stack<Direction> Explorer::getShortestPath_A(std::pair<int, int> src, std::
                 visited[neighbor] = true;
                 parent[neighbor] = t;
             }
-        }
+        });
         // Check for search mode conditions
-        if (search && ((mapped_areas_.count(t) != 0 && mapped_areas_[t].first > 0) || unexplored_areas_.count(t) != 0)) {
+        if (search && (dirty_areas_.count(t) != 0 || unexplored_areas_.count(t) != 0)) {
             found = true;
             break;
         }
@@ -160,16 +326,15 @@ std::stack<Direction> Explorer::getShortestPath_A(std::pair<int, int> src, std::
         while (!q.empty()) {
             Position t = q.front();
             q.pop();
-            for (const auto& v : getNeighbors({t.r, t.c})) {
-                Position neighbor = {v.first, v.second};
+            forEachNeighbor(t, [&](const Position& neighbor) {
                 if (visited.count(neighbor) == 0) {
                     q.push(neighbor);
                     visited[neighbor] = true;
                     parent[neighbor] = t;
                 }
-            }
+            });
             if (search) {
-                if (!((mapped_areas_.count(t) != 0 && mapped_areas_[t].first > 0) || unexplored_areas_.count(t) != 0)) {
+                if (!(dirty_areas_.count(t) != 0 || unexplored_areas_.count(t) != 0)) {
                     continue;
                 }
             }
@@ -193,6 +358,284 @@ std::stack<Direction> Explorer::getShortestPath_A(std::pair<int, int> src, std::
     }
     return path;
     } 
+// Check if the robot can stand on a position: explored and not a wall, or known to be unexplored
+bool Explorer::isPassable(const Position &pos) const {
+    auto it = mapped_areas_.find(pos);
+    if (it != mapped_areas_.end() && it->second.first != static_cast<int>(LocType::Wall)) {
+        return true;
+    }
+    return unexplored_areas_.count(pos) != 0;
+}
+
+// Move from pos in direction (dr, dc) until reaching the goal or a position where the shortest path may
+// turn (a jump point). Returns {-20, -20} if a wall is hit first. On 4-connected grids a horizontal move
+// stops next to the end of an obstacle, and a vertical move also stops wherever a horizontal jump succeeds.
+// Passability is read from the neighbour masks: the mask of the position behind tells whether the next one is
+// passable, and comparing the two masks finds an obstacle ending beside the way.
+Position Explorer::jump(Position pos, int dr, int dc, const Position &goal, HorizontalJumps &horizontal) const {
+    if (dc != 0) {
+        return jumpHorizontal(pos, dc, goal, horizontal);
+    }
+    const unsigned ahead = dr > 0 ? kDown : kUp;
+    unsigned behind = getNeighborMask({pos.r - dr, pos.c});
+    while (true) {
+        if ((behind & ahead) == 0) {
+            return {-20, -20};
+        }
+        if (pos == goal) {
+            return pos;
+        }
+        unsigned mask = getNeighborMask(pos);
+        if ((mask & ~behind & (kLeft | kRight)) != 0) {
+            return pos;
+        }
+        if (((mask & kRight) != 0 && jumpHorizontal({pos.r, pos.c + 1}, 1, goal, horizontal).r != -20) ||
+            ((mask & kLeft) != 0 && jumpHorizontal({pos.r, pos.c - 1}, -1, goal, horizontal).r != -20)) {
+            return pos;
+        }
+        behind = mask;
+        pos = {pos.r + dr, pos.c};
+    }
+}
+
+// Horizontal part of jump. Every position a horizontal jump passes leads to the same end, so the end is
+// remembered for all of them: the probes made at each row of a vertical jump are not repeated when another
+// vertical jump crosses the same positions, and a search walks each position at most once per direction.
+Position Explorer::jumpHorizontal(Position pos, int dc, const Position &goal, HorizontalJumps &horizontal) const {
+    auto &known = dc > 0 ? horizontal.right : horizontal.left;
+    const unsigned ahead = dc > 0 ? kRight : kLeft;
+    unsigned behind = getNeighborMask({pos.r, pos.c - dc});
+    std::vector<Position> walked;
+    Position end = {-20, -20};
+    while (true) {
+        auto it = known.find(HorizontalJumps::key(pos));
+        if (it != known.end()) {
+            end = it->second;
+            break;
+        }
+        if ((behind & ahead) == 0) {
+            break;
+        }
+        walked.push_back(pos);
+        unsigned mask = getNeighborMask(pos);
+        if (pos == goal || (mask & ~behind & (kUp | kDown)) != 0) {
+            end = pos;
+            break;
+        }
+        behind = mask;
+        pos = {pos.r, pos.c + dc};
+    }
+    for (const auto &p : walked) {
+        known[HorizontalJumps::key(p)] = end;
+    }
+    return end;
+}
+
+// Find the shortest path from src to dst with jump point search. Only jump points are pushed to the open
+// list, so large open areas of the known map are crossed without expanding every position in them.
+std::stack<Direction> Explorer::getShortestPath_JPS(std::pair<int, int> src, std::pair<int, int> dst) {
+    std::stack<Direction> path;
+    Position start = {src.first, src.second};
+    Position goal = {dst.first, dst.second};
+
+    // (f, position) ordered so that the smallest f is popped first
+    std::priority_queue<std::pair<int, Position>, std::vector<std::pair<int, Position>>,
+            std::greater<std::pair<int, Position>>> open;
+    std::map<Position, int> g;
+    std::map<Position, Position> parent;
+    std::set<Position> closed;
+    HorizontalJumps horizontal;
+
+    g[start] = 0;
+    open.push({manhattanDistance(start, goal), start});
+    bool found = false;
+    while (!open.empty()) {
+        Position t = open.top().second;
+        open.pop();
+        if (!closed.insert(t).second) {
+            continue;
+        }
+        if (t == goal) {
+            found = true;
+            break;
+        }
+
+        // Directions worth jumping in, pruned by the direction we arrived from
+        std::vector<std::pair<int, int>> directions;
+        auto from = parent.find(t);
+        if (from == parent.end()) {
+            directions = {{-1, 0}, {1, 0}, {0, 1}, {0, -1}};
+        } else {
+            int dr = (t.r > from->second.r) - (t.r < from->second.r);
+            int dc = (t.c > from->second.c) - (t.c < from->second.c);
+            if (dc != 0) {
+                directions = {{-1, 0}, {1, 0}, {0, dc}};
+            } else {
+                directions = {{0, -1}, {0, 1}, {dr, 0}};
+            }
+        }
+
+        for (const auto& [dr, dc] : directions) {
+            Position next = jump({t.r + dr, t.c + dc}, dr, dc, goal, horizontal);
+            if (next.r == -20 || closed.count(next) != 0) {
+                continue;
+            }
+            int cost = g[t] + manhattanDistance(t, next);
+            auto known = g.find(next);
+            if (known == g.end() || cost < known->second) {
+                g[next] = cost;
+                parent[next] = t;
+                open.push({cost + manhattanDistance(next, goal), next});
+            }
+        }
+    }
+
+    if (found) {
+        // Every pair of consecutive jump points is joined by a straight line
+        Position v = goal;
+        while (v != start) {
+            Position p = parent[v];
+            Direction dir = PositionUtils::findDirection(p, {p.r + (v.r > p.r) - (v.r < p.r),
+                                                             p.c + (v.c > p.c) - (v.c < p.c)});
+            for (int i = manhattanDistance(p, v); i > 0; --i) {
+                path.push(dir);
+            }
+            v = p;
+        }
+    } else if (start != goal) {
+        std::cerr << "Warning: Empty path returned for src: (" << src.first << "," << src.second
+                  << ") to dst: (" << dst.first << "," << dst.second << ")" << std::endl;
+    }
+    return path;
+}
+
+// Check if the known map is mostly open floor: few walls compared to the positions the robot can stand on
+bool Explorer::isOpenMap() const {
+    std::size_t walls = discovered_walls_.size();
+    std::size_t passable = mapped_areas_.size() + unexplored_areas_.size() - std::min(walls, mapped_areas_.size());
+    return walls * 2 < passable;
+}
+
+// Find the shortest path from src to dst by growing a BFS from each end, always expanding a whole layer of
+// the smaller side, until the two meet. Each side only needs to reach about half the distance.
+std::stack<Direction> Explorer::getShortestPath_Bidirectional(std::pair<int, int> src, std::pair<int, int> dst) {
+    std::stack<Direction> path;
+    Position start = {src.first, src.second};
+    Position goal = {dst.first, dst.second};
+    if (start == goal) {
+        return path;
+    }
+
+    std::map<Position, int> distForward, distBackward;
+    std::map<Position, Position> parentForward, parentBackward;
+    std::vector<Position> frontierForward = {start}, frontierBackward = {goal};
+    distForward[start] = 0;
+    distBackward[goal] = 0;
+
+    // Best meeting found so far: the edge meetFrom -> meetTo joins the forward and backward trees
+    int best = INT_MAX;
+    Position meetFrom = {-20, -20};
+    Position meetTo = {-20, -20};
+    while (!frontierForward.empty() && !frontierBackward.empty() && best == INT_MAX) {
+        bool forward = frontierForward.size() <= frontierBackward.size();
+        auto& frontier = forward ? frontierForward : frontierBackward;
+        auto& dist = forward ? distForward : distBackward;
+        auto& parent = forward ? parentForward : parentBackward;
+        const auto& otherDist = forward ? distBackward : distForward;
+
+        std::vector<Position> nextFrontier;
+        for (const auto& t : frontier) {
+            forEachNeighbor(t, [&](const Position& neighbor) {
+                auto other = otherDist.find(neighbor);
+                if (other != otherDist.end()) {
+                    // Finish the layer anyway, a later position of it may close a shorter path
+                    int length = dist[t] + 1 + other->second;
+                    if (length < best) {
+                        best = length;
+                        meetFrom = forward ? t : neighbor;
+                        meetTo = forward ? neighbor : t;
+                    }
+                }
+                if (dist.count(neighbor) == 0) {
+                    dist[neighbor] = dist[t] + 1;
+                    parent[neighbor] = t;
+                    nextFrontier.push_back(neighbor);
+                }
+            });
+        }
+        frontier.swap(nextFrontier);
+    }
+
+    if (best == INT_MAX) {
+        std::cerr << "Warning: Empty path returned for src: (" << src.first << "," << src.second
+                  << ") to dst: (" << dst.first << "," << dst.second << ")" << std::endl;
+        return path;
+    }
+
+    // The stack is built from the last move backwards: first meetTo -> goal, then the meeting edge,
+    // then start -> meetFrom
+    std::vector<Direction> tail;
+    for (Position v = meetTo; v != goal; v = parentBackward[v]) {
+        tail.push_back(PositionUtils::findDirection(v, parentBackward[v]));
+    }
+    for (auto it = tail.rbegin(); it != tail.rend(); ++it) {
+        path.push(*it);
+    }
+    path.push(PositionUtils::findDirection(meetFrom, meetTo));
+    for (Position v = meetFrom; v != start; v = parentForward[v]) {
+        path.push(PositionUtils::findDirection(parentForward[v], v));
+    }
+    return path;
+}
+
+// Check whether plan can still be followed from src towards dst
+bool Explorer::isPlanUsable(PathPlan &plan, const Position &src, const Position &dst, bool search) {
+    if (!plan.valid_ || plan.position_ != src || plan.search_ != search) {
+        return false;
+    }
+    if (search) {
+        // The target must still be worth going to
+        if (dirty_areas_.count(plan.target_) == 0 && unexplored_areas_.count(plan.target_) == 0) {
+            return false;
+        }
+    } else if (plan.target_ != dst) {
+        return false;
+    }
+    for (std::size_t i = plan.wall_epoch_; i < discovered_walls_.size(); ++i) {
+        if (plan.cells_.count(discovered_walls_[i]) != 0) {
+            return false;
+        }
+    }
+    plan.wall_epoch_ = discovered_walls_.size();
+    return true;
+}
+
+// Keep plan pointing from src to dst, replanning only when it can no longer be followed
+bool Explorer::updatePlan(PathPlan &plan, std::pair<int, int> src, std::pair<int, int> dst, bool search) {
+    Position start = {src.first, src.second};
+    if (isPlanUsable(plan, start, {dst.first, dst.second}, search)) {
+        return false;
+    }
+    std::stack<Direction> path = getShortestPath_A(src, dst, search);
+    plan.moves_.clear();
+    plan.cells_.clear();
+    plan.position_ = start;
+    plan.search_ = search;
+    plan.wall_epoch_ = discovered_walls_.size();
+    plan.valid_ = true;
+
+    Position v = start;
+    plan.cells_.insert(v);
+    while (!path.empty()) {
+        plan.moves_.push_back(path.top());
+        v = PositionUtils::movePosition(v, path.top());
+        plan.cells_.insert(v);
+        path.pop();
+    }
+    plan.target_ = search ? v : Position{dst.first, dst.second};
+    return true;
+}
+
 // Get the shortest path from source to destination, or to the closest dirt/unexplored area if search is true
 std::stack<Direction> Explorer::getShortestPath(std::pair<int, int> src, std::pair<int, int> dst, bool search) {
     std::stack<Direction> path;
@@ -210,17 +653,16 @@ std::stack<Direction> Explorer::getShortestPath(std::pair<int, int> src, std::pa
         Position t = q.front();
         q.pop();
 
-        for (const auto& v : getNeighbors({t.r, t.c})) {
-            Position neighbor = {v.first, v.second};
+        forEachNeighbor(t, [&](const Position& neighbor) {
             if (visited.count(neighbor) == 0) { // If not visited
                 q.push(neighbor);
                 visited[neighbor] = true;
                 parent[neighbor] = t;
             }
-        }
+        });
 
         if (search) {
-            if (!((mapped_areas_.count(t) != 0 && mapped_areas_[t].first > 0) || unexplored_areas_.count(t) != 0)) {
+            if (!(dirty_areas_.count(t) != 0 || unexplored_areas_.count(t) != 0)) {
                 continue;
             }
         }
@@ -246,31 +688,82 @@ std::stack<Direction> Explorer::getShortestPath(std::pair<int, int> src, std::pa
     return path;}
 
 bool Explorer::hasMoreDirtyAreas() const {
-    for (const auto& area : mapped_areas_) {
-        if (area.second.first > 0) {  // Check if there's any dirt left in any mapped area
-            return true;
+    return !dirty_areas_.empty();
+}
+
+std::size_t Explorer::getDirtyAreaCount() const {
+    return dirty_areas_.size();
+}
+
+// Get the closest known dirty area reachable from position, or {-20, -20} if there is none
+Position Explorer::getClosestDirtyArea(Position position) {
+    int distance;
+    return getClosestDirtyArea(position, distance);
+}
+
+// Breadth-first search from position, also returning the number of steps to the dirty area found (-1 if none)
+Position Explorer::getClosestDirtyArea(Position position, int &distance) {
+    distance = -1;
+    if (dirty_areas_.empty()) {
+        return {-20, -20};
+    }
+    std::vector<Position> layer = {position};
+    std::set<Position> visited = {position};
+    for (int depth = 0; !layer.empty(); ++depth) {
+        std::vector<Position> next;
+        for (const auto &t : layer) {
+            if (dirty_areas_.count(t) != 0) {
+                distance = depth;
+                return t;
+            }
+            forEachNeighbor(t, [&](const Position& neighbor) {
+                if (visited.insert(neighbor).second) {
+                    next.push_back(neighbor);
+                }
+            });
         }
+        layer.swap(next);
     }
-    return false;
+    return {-20, -20};
 }
 
 // Get the neighboring positions for a given point
 std::vector<std::pair<int, int>> Explorer::getNeighbors(std::pair<int, int> point) {
-    static std::vector<std::pair<int, int>> directions = {
-            {-1, 0}, {1, 0}, {0, 1}, {0, -1}
-    };
-
     std::vector<std::pair<int, int>> neighbors;
+    forEachNeighbor({point.first, point.second}, [&](const Position& neighbor) {
+        neighbors.push_back({neighbor.r, neighbor.c});
+    });
+    return neighbors;
+}
 
-    for (const auto& dir : directions) {
-        std::pair<int, int> temp = {point.first + dir.first, point.second + dir.second};
+// Get the mask of passable neighbours of a position, see kNeighborOrder for the meaning of each bit
+std::uint8_t Explorer::getNeighborMask(const Position &pos) const {
+    auto it = neighbor_masks_.find(pos);
+    return it == neighbor_masks_.end() ? 0 : it->second;
+}
 
-        if ((mapped_areas_.count({temp.first, temp.second}) != 0 && !isWall({temp.first, temp.second})) ||
-            unexplored_areas_.count({temp.first, temp.second}) != 0) {
-            neighbors.push_back(temp);
+// Recompute whether pos is passable and record it in the masks of its four neighbours
+void Explorer::refreshPassability(const Position pos) {
+    bool passable = isPassable(pos);
+    // pos is the upper neighbour of the position below it, so bit 0 of that mask tells whether pos was passable
+    Position below = {pos.r - kNeighborOrder[0].r, pos.c - kNeighborOrder[0].c};
+    if (((getNeighborMask(below) & kUp) != 0) == passable) {
+        return;
+    }
+    ++map_version_;
+    map_changes_.push_back(pos);
+    for (int i = 0; i < 4; ++i) {
+        Position neighbor = {pos.r - kNeighborOrder[i].r, pos.c - kNeighborOrder[i].c};
+        std::uint8_t bit = 1u << i;
+        if (passable) {
+            neighbor_masks_[neighbor] |= bit;
+        } else {
+            auto it = neighbor_masks_.find(neighbor);
+            if (it != neighbor_masks_.end()) {
+                it->second &= ~bit;
+            }
         }
     }
-    return neighbors;
 }
 /*std::stack<Direction> Explorer::findPathToDock(const Position& start, const Position& dock) {
     std::cout << "Finding path to dock from (" << start.r << "," << start.c 
@@ -369,15 +862,72 @@ std::stack<Direction> Explorer::reconstructPath(const std::map<Position, Positio
     return path;
 }*/
 Position Explorer::getClosestUnexploredArea(Position position) {
-    int Dist = 0;
-    int min = INT_MAX;
-    Position pos = {-20, -20};
-    for (const auto& area : unexplored_areas_) {
-        Dist = getShortestPath_A({position.r, position.c}, {area.first.r, area.first.c}, false).size();
-        if (Dist < min) {
-            min = Dist;
-            pos = area.first;
+    int distance;
+    return getClosestUnexploredArea(position, distance);
+}
+
+// Breadth-first search from position that stops at the first layer holding an unexplored area,
+// so the cost depends on how far the frontier is and not on how many unexplored areas there are.
+// Ties inside that layer go to the smallest position.
+// In position order the search tree does not depend on the goal, so one pass over the known map gives the
+// length getShortestPath_A would plan to every unexplored area; a goal found later may still be closer, so the
+// whole map is searched.
+Position Explorer::getClosestUnexploredArea(Position position, int &distance, SearchOrder order) {
+    distance = -1;
+    if (!isPassable(position)) {
+        return {-20, -20};
+    }
+    if (order == SearchOrder::Position) {
+        std::priority_queue<Position, std::vector<Position>, std::greater<Position>> queue;
+        std::map<Position, int> depth = {{position, 0}};
+        queue.push(position);
+        Position best = {-20, -20};
+        while (!queue.empty()) {
+            Position pos = queue.top();
+            queue.pop();
+            int steps = depth[pos];
+            if (isAreaUnexplored(pos) && (best.r == -20 || steps < distance || (steps == distance && pos < best))) {
+                best = pos;
+                distance = steps;
+            }
+            forEachNeighbor(pos, [&](const Position &neighbor) {
+                if (depth.emplace(neighbor, steps + 1).second) {
+                    queue.push(neighbor);
+                }
+            });
         }
+        return best;
     }
-    return pos;
+    std::vector<Position> layer = {position};
+    std::set<Position> visited = {position};
+    for (int depth = 0; !layer.empty(); ++depth) {
+        Position best = {-20, -20};
+        for (const auto &pos : layer) {
+            if (isAreaUnexplored(pos) && (best.r == -20 || pos < best)) {
+                best = pos;
+            }
+        }
+        if (best.r != -20) {
+            distance = depth;
+            return best;
+        }
+        std::vector<Position> next;
+        for (const auto &pos : layer) {
+            forEachNeighbor(pos, [&](const Position &neighbor) {
+                if (visited.insert(neighbor).second) {
+                    next.push_back(neighbor);
+                }
+            });
+        }
+        layer.swap(next);
+    }
+    return {-20, -20};
+}
+
+std::size_t Explorer::getMapVersion() const {
+    return map_version_;
+}
+
+const std::pmr::vector<Position>& Explorer::getMapChanges() const {
+    return map_changes_;
 }
\ No newline at end of file
@@ -7,19 +7,58 @@
 
 #include <stack>
 #include <map>
+#include <unordered_map>
 #include "../common/states.h"
 #include "../common/enums.h"
 #include "../common/PositionUtils.h"
+#include "PathPlan.h"
+#include "../common/BitBfs.h"
+#include "../common/PlannerApi.h"
 #include <climits>
+#include <cstdint>
+#include <bit>
+#include <memory>
+#include <memory_resource>
 
 
 
 #include <set>
 
-class Explorer {
+// A pmr container keeps the resource it was built with, so moving it to another one means building it again
+template <typename Container>
+void rebuildOnResource(Container &container, std::pmr::memory_resource *resource) {
+    std::destroy_at(&container);
+    std::construct_at(&container, resource);
+}
+
+// Distances from one position to every position of a rectangle of the known map
+struct DistanceField {
+    Position origin = {0, 0}; // top left corner of the rectangle
+    int rows = 0;
+    int cols = 0;
+    std::vector<int> distances; // row by row, -1 if not reachable
+
+    int at(const Position &pos) const {
+        int r = pos.r - origin.r;
+        int c = pos.c - origin.c;
+        if (r < 0 || r >= rows || c < 0 || c >= cols) {
+            return -1;
+        }
+        return distances[static_cast<std::size_t>(r) * cols + c];
+    }
+};
+
+class PLANNER_API Explorer {
 public:
-    Explorer();
+    // The map is allocated from resource, see AllocatorAwareAlgorithm
+    explicit Explorer(std::pmr::memory_resource *resource = std::pmr::get_default_resource());
     ~Explorer() = default;
+    // Forget the map, as for a new run. With the same resource vectors keep their capacity, otherwise the
+    // map is built again on the new one and nothing from the old one is kept.
+    void reset();
+    void reset(std::pmr::memory_resource *resource);
+    // The resource the map is allocated from; planners working on the map allocate from it too
+    std::pmr::memory_resource *getMemoryResource() const;
     bool explored(const Position pos) const;
     int getDirtLevel(const Position pos);
     void setDirtLevel(const Position pos, int dirtLevel);
@@ -41,7 +80,15 @@ public:
     void removeFromUnexplored(const Position pos);
     void updateAdjacentArea(Direction dir, Position position, bool isWall);
 
+    // Frontier index: unexplored areas bucketed by their estimated distance from the docking station
+    void setDockingStation(const Position pos);
+    int getFrontierDockDistance(const Position pos) const;
+    Position getNearestFrontier(int maxDockDistance) const;
+
     bool hasMoreDirtyAreas() const;
+    std::size_t getDirtyAreaCount() const;
+    Position getClosestDirtyArea(Position position);
+    Position getClosestDirtyArea(Position position, int &distance);
 
     std::stack<Direction> getShortestPath(std::pair<int, int> src,
                                           std::pair<int, int> dst,
@@ -51,7 +98,26 @@ public:
                                           std::pair<int, int> dst,
                                           bool search);
 
-    int manhattanDistance(const Position &a, const Position &b);
+    // Jump point search over the known map, returns a shortest path from src to dst
+    std::stack<Direction> getShortestPath_JPS(std::pair<int, int> src,
+                                              std::pair<int, int> dst);
+
+    // Breadth-first search from both ends at once, returns a shortest path from src to dst
+    std::stack<Direction> getShortestPath_Bidirectional(std::pair<int, int> src,
+                                                        std::pair<int, int> dst);
+
+    // Passable areas of the smallest rectangle holding them all; field gets the rectangle, without distances
+    BitGrid getPassableGrid(DistanceField &field) const;
+
+    bool isPassable(const Position &pos) const;
+    // Explored and not a wall, unlike isPassable which also accepts unexplored areas
+    bool isKnownFloor(const Position &pos) const;
+
+    int manhattanDistance(const Position &a, const Position &b) const;
+
+    // Keep plan pointing from src to dst (or to the closest dirt/unexplored area if search is true),
+    // replanning only when it can no longer be followed. Returns true if a new path was computed.
+    bool updatePlan(PathPlan &plan, std::pair<int, int> src, std::pair<int, int> dst, bool search);
 
     std::stack<Direction> reconstructPath(const std::map<Position, Position> &parent, Position current, Position start);
 
@@ -61,14 +127,77 @@ public:
     //std::stack<Direction> reconstructPath(const std::map<Position, Position> &cameFrom, const Position &current, const Position &start) const;
 
     std::vector<std::pair<int, int>> getNeighbors(std::pair<int, int> point);
+    std::uint8_t getNeighborMask(const Position &pos) const;
+
+    // Call visit(neighbor) for every passable neighbour of pos, in kNeighborOrder, without allocating
+    template <typename Visitor>
+    void forEachNeighbor(const Position &pos, Visitor &&visit) const {
+        unsigned mask = getNeighborMask(pos);
+        while (mask != 0) {
+            int i = std::countr_zero(mask);
+            mask &= mask - 1;
+            visit(Position{pos.r + kNeighborOrder[i].r, pos.c + kNeighborOrder[i].c});
+        }
+    }
+    // Order in which the search for the closest unexplored area expands cells
+    enum class SearchOrder {
+        Breadth,  // layer by layer, so distances are shortest path lengths
+        Position, // smallest discovered position first, the order getShortestPath_A expands cells in on small
+                  // maps; distances are the lengths of the paths that search plans, which may not be the shortest
+    };
     Position getClosestUnexploredArea(Position position);
+    // Same, also returning the number of steps to it in distance (-1 if no unexplored area is reachable).
+    // Ties go to the smallest position.
+    Position getClosestUnexploredArea(Position position, int &distance, SearchOrder order = SearchOrder::Breadth);
+    // Changes whenever passability or the set of unexplored areas changes, so query results can be cached
+    std::size_t getMapVersion() const;
+    // Positions whose passability or explored state changed, in order; one entry per map version
+    const std::pmr::vector<Position>& getMapChanges() const;
     std::stack<Direction> findPathToDock(const Position &start, const Position &dock);
-    std::map<Position, std::pair<int, int>> mapped_areas_; // first: dirt level, second: curr distance from docking station
-    std::map<Position, bool> unexplored_areas_;
+    std::pmr::map<Position, std::pair<int, int>> mapped_areas_; // first: dirt level, second: curr distance from docking station
+    std::pmr::map<Position, bool> unexplored_areas_;
 
 private:
-    
+    // Offsets of the neighbours in search order; bit i of a neighbour mask refers to kNeighborOrder[i]
+    static constexpr Position kNeighborOrder[4] = {{-1, 0}, {1, 0}, {0, 1}, {0, -1}};
+    static constexpr unsigned kUp = 1u << 0;
+    static constexpr unsigned kDown = 1u << 1;
+    static constexpr unsigned kRight = 1u << 2;
+    static constexpr unsigned kLeft = 1u << 3;
+
+    void refreshPassability(const Position pos);
+    void addToFrontier(const Position pos, int dockDistance);
+    void removeFromFrontier(const Position pos);
+    void updateDirtyIndex(const Position pos);
+
     int total_dirt_;
+    Position docking_station_ = {-20, -20};
+    std::pmr::map<int, std::pmr::set<Position>> frontier_buckets_; // dock distance -> unexplored areas at that distance
+    std::pmr::map<Position, int> frontier_dock_distance_;          // unexplored area -> its bucket in frontier_buckets_
+    std::pmr::set<Position> dirty_areas_;                           // explored areas with dirt level above 0
+    std::pmr::vector<Position> discovered_walls_;                   // walls in the order they were discovered
+    std::pmr::map<Position, std::uint8_t> neighbor_masks_;          // position -> which of its neighbours are passable
+
+    bool isPlanUsable(PathPlan &plan, const Position &src, const Position &dst, bool search);
+    // Ends of the horizontal jumps of one search, by the position passed and the direction, see jumpHorizontal
+    struct HorizontalJumps {
+        static std::uint64_t key(const Position &pos) {
+            return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(pos.r)) << 32) |
+                   static_cast<std::uint32_t>(pos.c);
+        }
+        std::unordered_map<std::uint64_t, Position> left;
+        std::unordered_map<std::uint64_t, Position> right;
+    };
+    Position jump(Position pos, int dr, int dc, const Position &goal, HorizontalJumps &horizontal) const;
+    Position jumpHorizontal(Position pos, int dc, const Position &goal, HorizontalJumps &horizontal) const;
+
+    bool isOpenMap() const;
+
+    // Known maps at least this large are searched point-to-point with jump point search when they are open,
+    // and with bidirectional BFS otherwise
+    static constexpr std::size_t kJumpPointSearchMinCells = 400;
+    std::size_t map_version_ = 0;
+    std::pmr::vector<Position> map_changes_;
 };
 
 #endif //VACUUM_FINAL_EXPLORER_H
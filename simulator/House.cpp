@@ -4,7 +4,8 @@
 #include <stdexcept>
 
 House::House(const std::vector<std::string>& layout_v, const std::string& name)
-        : dockingStation({-1, -1}), total_dirt(0), house_name(name),dirt_count(0) {  // Save the house name
+        : dockingStation({-1, -1}), total_dirt(0), house_name(name),dirt_count(0),
+          analysis(std::make_shared<WallAnalysis>()) {  // Save the house name
     std::vector<std::string> padded_layout = layout_v;
     //addWallsPadding(padded_layout);
     initializeMatrix(padded_layout);
@@ -12,6 +13,54 @@ House::House(const std::vector<std::string>& layout_v, const std::string& name)
     updateDirtCount();
 }
 
+House::House(const House& other, std::pmr::memory_resource* resource)
+        : cells(other.cells, resource), rows(other.rows), cols(other.cols), dockingStation(other.dockingStation),
+          total_dirt(other.total_dirt), dirt_count(other.dirt_count), house_name(other.house_name),
+          analysis(other.analysis), quiet(other.quiet) {
+}
+
+// Find the cells reachable from the docking station with the bit-parallel BFS. Only runs that need it (pruning,
+// dirt variants) pay for it, once per loaded house whichever copy asks first.
+const House::WallAnalysis& House::analyzeWalls() const {
+    std::call_once(analysis->done, [this] {
+        BitGrid open(rows, cols);
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j) {
+                open.set(i, j, cells[index(i, j)] != -1);
+            }
+        }
+        analysis->reachable = BitBfs::reachable(open, dockingStation);
+        analysis->dockDistances = BitBfs::distanceField(open, dockingStation);
+        analysis->passable = std::move(open);
+    });
+    return *analysis;
+}
+
+const std::vector<int>& House::getDockDistances() const {
+    return analyzeWalls().dockDistances;
+}
+
+House House::makeDirtVariant(std::mt19937_64& rng) const {
+    House variant = *this;
+    const BitGrid& reachable = analyzeWalls().reachable;
+    std::vector<std::size_t> floor;
+    std::vector<int> dirt;
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            int cell = cells[index(i, j)];
+            if (reachable.test(i, j) && cell >= 0 && cell < 10) {
+                floor.push_back(index(i, j));
+                dirt.push_back(cell);
+            }
+        }
+    }
+    std::shuffle(dirt.begin(), dirt.end(), rng);
+    for (std::size_t k = 0; k < floor.size(); ++k) {
+        variant.cells[floor[k]] = dirt[k];
+    }
+    return variant;
+}
+
 void House::addWallsPadding(std::vector<std::string>& layout_v) {
     if (layout_v.empty()) return;
 
@@ -36,15 +85,15 @@ void House::addWallsPadding(std::vector<std::string>& layout_v) {
 void House::initializeMatrix(const std::vector<std::string>& layout_v) {
     rows = static_cast<int>(layout_v.size());
     cols = static_cast<int>(layout_v[0].size());
-    house_matrix.resize(rows, std::vector<int>(cols, 0));
+    cells.assign(static_cast<std::size_t>(rows) * cols, 0);
 
     for (int i = 0; i < rows; ++i) {
         for (int j = 0; j < cols; ++j) {
             char cell = layout_v[i][j];
             if (cell == 'W') {
-                house_matrix[i][j] = -1; // Wall
+                cells[index(i, j)] = -1; // Wall
             } else if (cell >= '1' && cell <= '9') {
-                house_matrix[i][j] = cell - '0'; // Dirt level
+                cells[index(i, j)] = cell - '0'; // Dirt level
 
                 // Check if the cell is not surrounded by walls
                 bool surrounded_by_walls = true;
@@ -63,14 +112,14 @@ void House::initializeMatrix(const std::vector<std::string>& layout_v) {
 
                 // Only add the dirt to total_dirt if not surrounded by walls
                 if (!surrounded_by_walls) {
-                    total_dirt += house_matrix[i][j];
+                    total_dirt += cells[index(i, j)];
                 }
             } else if (cell == 'D') {
                 dockingStation = {i, j};
                 std::cout << "Docking station found at (" << i << ", " << j << ")" << std::endl;
-                house_matrix[i][j] = -20; // Docking station
+                cells[index(i, j)] = -20; // Docking station
             } else {
-                house_matrix[i][j] = 0; // Empty space
+                cells[index(i, j)] = 0; // Empty space
             }
         }
     }
@@ -85,11 +134,9 @@ void House::findDockingStation() {
 
 void House::updateDirtCount() {
     dirt_count = 0;
-    for (const auto& row : house_matrix) {
-        for (int cell : row) {
-            if (cell > 0 && cell < 20) {
-                dirt_count += cell;
-            }
+    for (int cell : cells) {
+        if (cell > 0 && cell < 20) {
+            dirt_count += cell;
         }
     }
 }
@@ -110,7 +157,7 @@ int House::getCell(const Position& pos) const {
     if (pos.r < 0 || pos.r >= rows || pos.c < 0 || pos.c >= cols) {
         return -1; // Boundary walls represented by -1
     }
-    return house_matrix[pos.r][pos.c];
+    return cells[index(pos.r, pos.c)];
 }
 
 void House::printHouseMatrix() const {
@@ -118,7 +165,7 @@ void House::printHouseMatrix() const {
     for (int i = 0; i < rows; ++i) {
         for (int j = 0; j < cols; ++j) {
             char displayChar;
-            switch(house_matrix[i][j]) {
+            switch(cells[index(i, j)]) {
                 case -1:
                     displayChar = 'W';  // Wall
                     break;
@@ -129,7 +176,7 @@ void House::printHouseMatrix() const {
                     displayChar = '0';  // Empty space
                     break;
                 default:
-                    displayChar = '0' + house_matrix[i][j];  // Dirt level (1-9)
+                    displayChar = '0' + cells[index(i, j)];  // Dirt level (1-9)
                     break;
             }
             std::cout << displayChar << ' ';
@@ -146,6 +193,16 @@ bool House::isWall(const Position& pos) const {
     return getCell(pos) == -1;
 }
 
+// Walls around pos, bit i set if there is a wall in Direction(i); read straight from the flat buffer
+std::uint8_t House::getWallMask(const Position& pos) const {
+    std::uint8_t mask = 0;
+    if (getCell({pos.r - 1, pos.c}) == -1) mask |= 1u << static_cast<int>(Direction::North);
+    if (getCell({pos.r, pos.c + 1}) == -1) mask |= 1u << static_cast<int>(Direction::East);
+    if (getCell({pos.r + 1, pos.c}) == -1) mask |= 1u << static_cast<int>(Direction::South);
+    if (getCell({pos.r, pos.c - 1}) == -1) mask |= 1u << static_cast<int>(Direction::West);
+    return mask;
+}
+
 int House::getDirtLevel(const Position& pos) const {
     int cell = getCell(pos);
     if (pos == dockingStation) {
@@ -156,17 +213,25 @@ int House::getDirtLevel(const Position& pos) const {
 
 void House::cleanCell(const Position& pos) {
     if (pos.r >= 0 && pos.r < rows && pos.c >= 0 && pos.c < cols) {
-        if (house_matrix[pos.r][pos.c] > 0 && house_matrix[pos.r][pos.c] < 10) {
-            std::cout << "Cleaned cell at (" << pos.r << ", " << pos.c
-                      << "). dirt level: " << house_matrix[pos.r][pos.c] << std::endl;
-            house_matrix[pos.r][pos.c]--;
+        if (cells[index(pos.r, pos.c)] > 0 && cells[index(pos.r, pos.c)] < 10) {
+            if (!quiet) {
+                std::cout << "Cleaned cell at (" << pos.r << ", " << pos.c
+                          << "). dirt level: " << cells[index(pos.r, pos.c)] << std::endl;
+            }
+            cells[index(pos.r, pos.c)]--;
             total_dirt--;
-            std::cout << "Cleaned cell at (" << pos.r << ", " << pos.c
-                      << "). New dirt level: " << house_matrix[pos.r][pos.c] << std::endl;
+            if (!quiet) {
+                std::cout << "Cleaned cell at (" << pos.r << ", " << pos.c
+                          << "). New dirt level: " << cells[index(pos.r, pos.c)] << std::endl;
+            }
         }
     }
 }
 
+void House::setQuiet(bool enabled) {
+    quiet = enabled;
+}
+
 bool House::isValidPosition(const Position& pos) const {
     return pos.r >= 0 && pos.r < rows && pos.c >= 0 && pos.c < cols && !isWall(pos);
 }
@@ -187,8 +252,9 @@ void House::printMatrix() const {
     std::cout << "House matrix:\n";
     std::cout << "Docking station: (" << dockingStation.r << ", " << dockingStation.c << ")\n";
 
-    for (const auto& row : house_matrix) {
-        for (int cell : row) {
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            int cell = cells[index(i, j)];
             if (cell == -1) {
                 std::cout << "W ";
             } else if (cell == -20) {
@@ -205,11 +271,11 @@ void House::printLayout() const {
     std::cout << "House Layout:" << std::endl;
     for (int i = 0; i < rows; ++i) {
         for (int j = 0; j < cols; ++j) {
-            switch(house_matrix[i][j]) {
+            switch(cells[index(i, j)]) {
                 case 0: std::cout << ' '; break; // Empty
                 case -1: std::cout << 'W'; break; // Wall
                 case -20: std::cout << 'D'; break; // Docking station
-                default: std::cout << house_matrix[i][j]; // Dirt level
+                default: std::cout << cells[index(i, j)]; // Dirt level
             }
         }
         std::cout << std::endl;
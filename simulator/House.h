@@ -2,12 +2,22 @@
 #define HOUSE_H
 
 #include "../common/states.h"
+#include "../common/BitBfs.h"
+#include "../common/enums.h"
+#include "../common/PlannerApi.h"
+#include <cstdint>
 #include <vector>
 #include <string>
+#include <memory>
+#include <mutex>
+#include <memory_resource>
+#include <random>
 
-class House {
+class PLANNER_API House {
 public:
     House(const std::vector<std::string>& layout_v, const std::string& name);
+    // A copy whose cells are allocated from resource
+    House(const House& other, std::pmr::memory_resource* resource);
     ~House() = default;
     // Getters
     int getRows() const;
@@ -17,6 +27,7 @@ public:
     void printHouseMatrix() const;
     // Methods for assignment 3
     bool isWall(const Position& pos) const;
+    std::uint8_t getWallMask(const Position& pos) const;
     int getDirtLevel(const Position& pos) const;
     void cleanCell(const Position& pos);
     bool isValidPosition(const Position& pos) const;
@@ -26,19 +37,38 @@ public:
     // Utility methods
     int getTotalDirt() const;
     bool isHouseClean() const;
+    // Distance from the docking station to every cell, row by row, -1 for walls and unreachable cells. Part of
+    // the wall analysis, made on first use and shared by every copy of the house.
+    const std::vector<int>& getDockDistances() const;
+    // A copy with the dirt of the reachable cells shuffled among them. Walls, the docking station and the
+    // wall analysis stay shared with this house; the total dirt is unchanged.
+    House makeDirtVariant(std::mt19937_64& rng) const;
     void printMatrix() const;
     void printInfo() const;
     void printLayout() const;
+    // Do not log every cleaned cell
+    void setQuiet(bool enabled);
 
 private:
-    std::vector<std::vector<int>> house_matrix;
+    std::pmr::vector<int> cells; // row by row: -1 wall, -20 docking station, otherwise the dirt level
     int rows;
     int cols;
     Position dockingStation;
     int total_dirt;
     int dirt_count;
     std::string house_name;
+    // Depends only on the walls and the docking station, so copies and dirt variants share it
+    struct WallAnalysis {
+        std::once_flag done;
+        BitGrid passable;  // cells that are not walls
+        BitGrid reachable; // cells the robot can reach from the docking station
+        std::vector<int> dockDistances;
+    };
+    std::shared_ptr<WallAnalysis> analysis;
+    bool quiet = false;
 
+    const WallAnalysis& analyzeWalls() const;
+    std::size_t index(int r, int c) const { return static_cast<std::size_t>(r) * cols + c; }
 
     void addWallsPadding(std::vector<std::string>& layout_v);
     void initializeMatrix(const std::vector<std::string>& layout_v);
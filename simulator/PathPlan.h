@@ -0,0 +1,45 @@
+#ifndef VACUUM_FINAL_PATHPLAN_H
+#define VACUUM_FINAL_PATHPLAN_H
+
+#include <deque>
+#include <set>
+#include <cstddef>
+#include "../common/states.h"
+#include "../common/enums.h"
+#include "../common/PositionUtils.h"
+
+// A path computed by Explorer that the algorithm keeps across steps and consumes one move at a time.
+// Explorer only replans it when the robot left the path, the target changed or a newly discovered wall
+// lies on it (see Explorer::updatePlan).
+class PathPlan {
+public:
+    PathPlan() = default;
+
+    bool isValid() const { return valid_; }
+    bool empty() const { return moves_.empty(); }
+    std::size_t size() const { return moves_.size(); }
+    Direction peek() const { return moves_.front(); }
+    Position getTarget() const { return target_; }
+    void invalidate() { valid_ = false; }
+
+    // Consume the next move of the plan
+    Direction next() {
+        Direction dir = moves_.front();
+        moves_.pop_front();
+        position_ = PositionUtils::movePosition(position_, dir);
+        return dir;
+    }
+
+private:
+    friend class Explorer;
+
+    std::deque<Direction> moves_;
+    std::set<Position> cells_;     // every position the plan goes through
+    Position position_ = {-20, -20}; // where the robot is when the remaining moves start
+    Position target_ = {-20, -20};
+    bool search_ = false;
+    bool valid_ = false;
+    std::size_t wall_epoch_ = 0;   // number of walls Explorer knew about when the plan was last checked
+};
+
+#endif //VACUUM_FINAL_PATHPLAN_H
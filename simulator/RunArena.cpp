@@ -0,0 +1,67 @@
+#include "RunArena.h"
+#include <algorithm>
+#include <bit>
+
+RunArena::RunArena() : buffer_(new std::byte[kInitialBytes]) {
+    rebuild();
+    instances_.reset(&instance_pools_);
+    instances_.sibling = &requested_;
+    requested_.sibling = &instances_;
+}
+
+std::pmr::memory_resource *RunArena::resource() {
+    return &requested_;
+}
+
+std::pmr::memory_resource *RunArena::instanceResource() {
+    return &instances_;
+}
+
+std::size_t RunArena::used() const {
+    return std::max(requested_.peak, instances_.peak);
+}
+
+void RunArena::release() {
+    std::size_t needed = drawn_.total;
+    pools_.reset();
+    buffer_resource_.reset();
+    if (needed > capacity_) {
+        capacity_ = std::bit_ceil(needed);
+        buffer_.reset(new std::byte[capacity_]);
+    }
+    rebuild();
+    instances_.peak = instances_.live;
+}
+
+void RunArena::rebuild() {
+    buffer_resource_.emplace(buffer_.get(), capacity_, std::pmr::new_delete_resource());
+    drawn_.reset(&*buffer_resource_);
+    std::pmr::pool_options options;
+    options.largest_required_pool_block = kLargestPoolBlock;
+    pools_.emplace(options, &drawn_);
+    requested_.reset(&*pools_);
+}
+
+void RunArena::CountingResource::reset(std::pmr::memory_resource *to) {
+    upstream = to;
+    live = 0;
+    peak = 0;
+    total = 0;
+}
+
+void *RunArena::CountingResource::do_allocate(std::size_t size, std::size_t alignment) {
+    void *p = upstream->allocate(size, alignment);
+    live += size;
+    peak = std::max(peak, live + (sibling ? sibling->live : 0));
+    total += size;
+    return p;
+}
+
+void RunArena::CountingResource::do_deallocate(void *p, std::size_t size, std::size_t alignment) {
+    upstream->deallocate(p, size, alignment);
+    live -= size;
+}
+
+bool RunArena::CountingResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
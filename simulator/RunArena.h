@@ -0,0 +1,63 @@
+#ifndef VACUUM_FINAL_RUNARENA_H
+#define VACUUM_FINAL_RUNARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+// Memory for the state of the runs of one worker thread. A run allocates from pools on top of a buffer the
+// worker keeps, and release() gives everything back at once. Only the worker uses its arena, so nothing is
+// locked. When a run needs more than the buffer, the rest comes from the global heap and the buffer is enlarged
+// for the next runs.
+// The algorithm instances the worker keeps from one run to the next allocate from pools of their own that are
+// never released while the arena lives, so a reset instance keeps its memory warm for its next run.
+class RunArena {
+public:
+    RunArena();
+    RunArena(const RunArena &) = delete;
+    RunArena &operator=(const RunArena &) = delete;
+
+    std::pmr::memory_resource *resource();
+    // Memory for the algorithm instances, see AllocatorAwareAlgorithm; release() leaves it alone
+    std::pmr::memory_resource *instanceResource();
+    // Peak of the bytes held from resource() and instanceResource() together during the current run: what was
+    // asked for, not the pool chunks
+    std::size_t used() const;
+    // Free everything allocated since the last release; nothing allocated from resource() may be used after this
+    void release();
+
+private:
+    // Passes allocations on to upstream and keeps track of the bytes held
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        std::pmr::memory_resource *upstream = nullptr;
+        std::size_t live = 0;
+        std::size_t peak = 0;
+        std::size_t total = 0; // allocated since the last reset, whether freed or not
+        const CountingResource *sibling = nullptr; // its bytes held count towards peak too
+        void reset(std::pmr::memory_resource *to);
+
+    private:
+        void *do_allocate(std::size_t size, std::size_t alignment) override;
+        void do_deallocate(void *p, std::size_t size, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+    };
+
+    static constexpr std::size_t kInitialBytes = 256 * 1024;
+    // Blocks above this size bypass the pools; a run frees them only at release()
+    static constexpr std::size_t kLargestPoolBlock = 64 * 1024;
+
+    void rebuild();
+
+    std::size_t capacity_ = kInitialBytes;
+    std::unique_ptr<std::byte[]> buffer_;
+    std::optional<std::pmr::monotonic_buffer_resource> buffer_resource_;
+    CountingResource drawn_; // what the pools take from the buffer, to size it
+    std::optional<std::pmr::unsynchronized_pool_resource> pools_;
+    CountingResource requested_; // what the run takes from the pools
+    std::pmr::unsynchronized_pool_resource instance_pools_;
+    CountingResource instances_; // what the algorithm instances take from instance_pools_
+};
+
+#endif //VACUUM_FINAL_RUNARENA_H
@@ -1,6 +1,10 @@
 #include "Simulation.h"
 #include "SensorImpl.h"
 #include "Vacuum.h"
+#include "BatchedAlgorithm.h"
+#include "ResettableAlgorithm.h"
+#include "AllocatorAwareAlgorithm.h"
+#include "SnapshotAlgorithm.h"
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -11,125 +15,987 @@
 #include <fstream>
 #include <vector>
 #include <algorithm>
+#include <iterator>
+#include <tuple>
+#include <unordered_map>
+#include <random>
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 namespace fs = std::filesystem;
 
+namespace {
+// CPUs the simulator may run on, in ascending order
+std::vector<int> allowedCpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    return cpus;
+}
+
+// CPU time the calling thread has used so far
+std::chrono::nanoseconds threadCpuTime() {
+    timespec now{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return std::chrono::seconds(now.tv_sec) + std::chrono::nanoseconds(now.tv_nsec);
+}
+
+// Bind the calling thread to the slot-th of cpus, wrapping around
+void pinCurrentThread(const std::vector<int>& cpus, size_t slot) {
+    if (cpus.empty()) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[slot % cpus.size()], &set);
+    int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (error != 0) {
+        std::cerr << "Warning: Could not pin worker " << slot << " to CPU " << cpus[slot % cpus.size()] << ": "
+                  << std::strerror(error) << std::endl;
+    }
+}
+}
+
 Simulation::Simulation(std::vector<std::unique_ptr<House>> houses, std::vector<int> maxSteps, std::vector<int> maxBatteries)
     : houses(std::move(houses)), maxSteps(std::move(maxSteps)), maxBatteries(std::move(maxBatteries)) {}
 
-void Simulation::runSimulations(const std::vector<std::pair<std::string, std::function<std::unique_ptr<AbstractAlgorithm>()>>>& algorithms, int numThreads, bool summaryOnly) {
+Simulation::Simulation() : housesClosed(false) {}
+
+void Simulation::addHouse(std::unique_ptr<House> house, int maxSteps, int maxBattery) {
+    {
+        std::lock_guard<std::mutex> lock(housesMutex);
+        houses.push_back(std::move(house));
+        this->maxSteps.push_back(maxSteps);
+        maxBatteries.push_back(maxBattery);
+    }
+    housesAdded.notify_one();
+}
+
+void Simulation::closeHouses() {
+    {
+        std::lock_guard<std::mutex> lock(housesMutex);
+        housesClosed = true;
+    }
+    housesAdded.notify_all();
+}
+
+size_t Simulation::houseCount() {
+    std::lock_guard<std::mutex> lock(housesMutex);
+    return houses.size();
+}
+
+int Simulation::defaultThreadCount() {
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 0 ? static_cast<int>(hardwareThreads) : 10;
+}
+
+void Simulation::setPlacement(const PlacementOptions& options) {
+    placement = options;
+}
+
+// The house a worker runs: the loaded one, or with PlacementOptions::localHouses the worker's own copy of it
+const House& Simulation::houseFor(Worker& worker, const House& house) const {
+    if (!placement.localHouses) {
+        return house;
+    }
+    auto& local = worker.localHouses[&house];
+    if (!local) {
+        local = std::make_unique<House>(house);
+    }
+    return *local;
+}
+
+// Run body(0) .. body(numThreads - 1) on threads of their own, placed as set with setPlacement
+void Simulation::runWorkers(int numThreads, const std::function<void(size_t)>& body) const {
     std::vector<std::thread> threads;
-    std::atomic<size_t> houseIndex(0);
+    std::vector<int> cpus = placement.pinWorkers ? allowedCpus() : std::vector<int>();
 
-    auto worker = [this, &algorithms, &houseIndex, summaryOnly]() {
+    for (int i = 0; i < numThreads; ++i) {
+        threads.emplace_back([&body, &cpus](size_t workerIdx) {
+            pinCurrentThread(cpus, workerIdx);
+            body(workerIdx);
+        }, static_cast<size_t>(i));
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+// Run task(worker, 0) .. task(worker, count - 1) on numThreads threads, each taking the next index until none is
+// left; worker is the index of the thread running the task
+void Simulation::runTasks(size_t count, int numThreads, const std::function<void(size_t, size_t)>& task) const {
+    std::atomic<size_t> taskIndex(0);
+    runWorkers(numThreads, [&taskIndex, count, &task](size_t workerIdx) {
+        while (true) {
+            size_t index = taskIndex.fetch_add(1);
+            if (index >= count) break;
+            task(workerIdx, index);
+        }
+    });
+}
+
+std::unique_ptr<AbstractAlgorithm> Simulation::AlgorithmPool::acquire(
+        size_t algoIdx, const std::function<std::unique_ptr<AbstractAlgorithm>()>& factory) {
+    if (algoIdx < idle.size() && idle[algoIdx]) {
+        return std::move(idle[algoIdx]);
+    }
+    return factory();
+}
+
+void Simulation::AlgorithmPool::release(size_t algoIdx, std::unique_ptr<AbstractAlgorithm> algo) {
+    auto* resettable = dynamic_cast<ResettableAlgorithm*>(algo.get());
+    if (!resettable) {
+        return;
+    }
+    resettable->reset();
+    if (idle.size() <= algoIdx) {
+        idle.resize(algoIdx + 1);
+    }
+    idle[algoIdx] = std::move(algo);
+}
+
+// Run an algorithm on a copy of house with the worker's instance of it and the worker's arena. consume gets the
+// result while the arena still holds it; then the algorithm goes back to the pool and the arena is released. The
+// instance keeps what it allocated from the arena's instance resource for its next run on this worker.
+void Simulation::runOnWorker(Worker& worker, size_t algoIdx,
+                             const std::function<std::unique_ptr<AbstractAlgorithm>()>& factory, const House& house,
+                             int maxSteps, int maxBattery, int pruneAbove,
+                             const std::function<void(SimulationResult&)>& consume) {
+    std::pmr::memory_resource* resource = worker.arena.resource();
+    auto algo = worker.algorithms.acquire(algoIdx, factory);
+    if (auto* allocatorAware = dynamic_cast<AllocatorAwareAlgorithm*>(algo.get())) {
+        allocatorAware->setMemoryResource(worker.arena.instanceResource());
+    }
+    {
+        House simHouse(house, resource);
+        auto result = runScored(simHouse, *algo, maxSteps, maxBattery, pruneAbove, resource);
+        result.arenaBytes = worker.arena.used();
+        consume(result);
+    }
+    worker.algorithms.release(algoIdx, std::move(algo));
+    worker.arena.release();
+}
+
+void Simulation::runSimulations(const std::vector<std::pair<std::string, std::function<std::unique_ptr<AbstractAlgorithm>()>>>& algorithms, int numThreads, bool summaryOnly) {
+    std::vector<Worker> workers(numThreads);
+    size_t next = 0; // the next house to run, guarded by housesMutex
+    runWorkers(numThreads, [this, &algorithms, &workers, &next, summaryOnly](size_t worker) {
         while (true) {
-            size_t index = houseIndex.fetch_add(1);
-            if (index >= houses.size()) break;
+            const House* loaded;
+            int stepLimit;
+            int battery;
+            {
+                // The vectors may grow while houses are added, so only what the runs need is taken from them
+                std::unique_lock<std::mutex> lock(housesMutex);
+                housesAdded.wait(lock, [this, &next] { return next < houses.size() || housesClosed; });
+                if (next == houses.size()) {
+                    return;
+                }
+                loaded = houses[next].get();
+                stepLimit = maxSteps[next];
+                battery = maxBatteries[next];
+                ++next;
+            }
+            const House& house = houseFor(workers[worker], *loaded);
+            int best = INT_MAX;
+            for (size_t algoIdx = 0; algoIdx < algorithms.size(); ++algoIdx) {
+                const auto& [algoName, algoFactory] = algorithms[algoIdx];
+                best = std::min(best, runSingleSimulation(workers[worker], algoIdx, algoFactory, house, algoName,
+                                                          stepLimit, battery, summaryOnly, pruneThreshold(best)));
+            }
+        }
+    });
+}
+
+int Simulation::runSingleSimulation(Worker& worker, size_t algoIdx,
+                                    const std::function<std::unique_ptr<AbstractAlgorithm>()>& factory,
+                                    const House& house, const std::string& algoName, int maxSteps, int maxBattery,
+                                    bool summaryOnly, int pruneAbove) {
+    int score = 0;
+    runOnWorker(worker, algoIdx, factory, house, maxSteps, maxBattery, pruneAbove,
+                [&](SimulationResult& result) {
+        score = rankingScore(result);
+        {
+            std::lock_guard<std::mutex> lock(scoresMutex);
+            scores[{house.getName(), algoName}] = result.score;
+            runRecords[{house.getName(), algoName}] = {result.arenaBytes, result.wallMs, result.cpuMs};
+        }
+
+        if (!summaryOnly) {
+            writeOutputFile(house.getName(), algoName, result);
+        }
+    });
+    return score;
+}
+
+namespace {
+// A run for a worker process and what the worker sends back, see Simulation::runSimulationsInProcesses
+struct ProcessTask {
+    std::uint32_t house;
+    std::uint32_t algorithm;
+    std::int32_t pruneAbove;
+};
+
+struct ProcessResult {
+    std::int32_t steps;
+    std::int32_t dirtLeft;
+    std::int32_t score;
+    std::uint8_t finished;
+    std::uint8_t inDock;
+    std::uint8_t pruned;
+    std::uint64_t arenaBytes;
+    double wallMs;
+    double cpuMs;
+};
+
+struct WorkerProcess {
+    pid_t pid = -1;
+    int taskFd = -1;   // the simulator writes ProcessTasks here
+    int resultFd = -1; // and reads ProcessResults from here
+    long task = -1;    // index of the run the worker is on, -1 when idle
+    std::chrono::steady_clock::time_point deadline;
+};
+
+// Read all size bytes, retrying after signals; false at end of file or on error
+bool readFull(int fd, void* data, size_t size) {
+    auto* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t count = read(fd, bytes, size);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        bytes += count;
+        size -= count;
+    }
+    return true;
+}
+
+bool writeFull(int fd, const void* data, size_t size) {
+    const auto* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t count = write(fd, bytes, size);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        bytes += count;
+        size -= count;
+    }
+    return true;
+}
+
+void closeWorkerFds(WorkerProcess& process) {
+    if (process.taskFd >= 0) {
+        close(process.taskFd);
+    }
+    if (process.resultFd >= 0) {
+        close(process.resultFd);
+    }
+    process.taskFd = process.resultFd = -1;
+}
+
+// How a worker process that stopped answering ended
+std::string describeExit(int status) {
+    if (WIFSIGNALED(status)) {
+        return "killed by signal " + std::to_string(WTERMSIG(status)) + " (" + strsignal(WTERMSIG(status)) + ")";
+    }
+    if (WIFEXITED(status)) {
+        return "exited with status " + std::to_string(WEXITSTATUS(status));
+    }
+    return "stopped";
+}
+}
+
+void Simulation::runSimulationsInProcesses(const std::vector<std::pair<std::string, std::function<std::unique_ptr<AbstractAlgorithm>()>>>& algorithms, int numProcesses, bool summaryOnly) {
+    std::vector<std::pair<size_t, size_t>> tasks; // (house, algorithm)
+    for (size_t houseIdx = 0; houseIdx < houses.size(); ++houseIdx) {
+        for (size_t algoIdx = 0; algoIdx < algorithms.size(); ++algoIdx) {
+            tasks.emplace_back(houseIdx, algoIdx);
+        }
+    }
+    std::vector<int> best(houses.size(), INT_MAX);
+    std::vector<WorkerProcess> processes(std::min(static_cast<size_t>(numProcesses), tasks.size()));
 
-            for (const auto& [algoName, algoFactory] : algorithms) {
-                runSingleSimulation(*houses[index], algoFactory(), algoName, 
-                                    maxSteps[index], maxBatteries[index], summaryOnly);
+    // A worker that died must not take the simulator with it when its task pipe is written to
+    auto previousSigpipe = std::signal(SIGPIPE, SIG_IGN);
+    std::vector<int> cpus = placement.pinWorkers ? allowedCpus() : std::vector<int>();
+    auto spawn = [&](WorkerProcess& process) {
+        int taskPipe[2];
+        int resultPipe[2];
+        if (pipe(taskPipe) != 0) {
+            return false;
+        }
+        if (pipe(resultPipe) != 0) {
+            close(taskPipe[0]);
+            close(taskPipe[1]);
+            return false;
+        }
+        std::cout.flush();
+        pid_t pid = fork();
+        if (pid == 0) {
+            for (auto& other : processes) {
+                closeWorkerFds(other);
             }
+            close(taskPipe[1]);
+            close(resultPipe[0]);
+            pinCurrentThread(cpus, &process - processes.data());
+            runWorkerProcess(taskPipe[0], resultPipe[1], algorithms, summaryOnly);
+        }
+        close(taskPipe[0]);
+        close(resultPipe[1]);
+        if (pid < 0) {
+            close(taskPipe[1]);
+            close(resultPipe[0]);
+            return false;
+        }
+        process.pid = pid;
+        process.taskFd = taskPipe[1];
+        process.resultFd = resultPipe[0];
+        process.task = -1;
+        return true;
+    };
+    auto record = [&](size_t taskIdx, int score, bool pruned, const RunRecord& run) {
+        auto [houseIdx, algoIdx] = tasks[taskIdx];
+        if (!pruned) {
+            best[houseIdx] = std::min(best[houseIdx], score);
+        }
+        std::lock_guard<std::mutex> lock(scoresMutex);
+        scores[{houses[houseIdx]->getName(), algorithms[algoIdx].first}] = score;
+        runRecords[{houses[houseIdx]->getName(), algorithms[algoIdx].first}] = run;
+    };
+    // The run is lost with the worker; it scores as a run that used up all its steps
+    auto fail = [&](size_t taskIdx, const std::string& reason) {
+        auto [houseIdx, algoIdx] = tasks[taskIdx];
+        const std::string& houseName = houses[houseIdx]->getName();
+        const std::string& algoName = algorithms[algoIdx].first;
+        std::cerr << "Run of " << algoName << " on " << houseName << " failed: " << reason << std::endl;
+        std::ofstream errorFile(houseName + "-" + algoName + ".error");
+        errorFile << "Run failed: " << reason << std::endl;
+        SimulationResult result{};
+        markTimedOut(result, maxSteps[houseIdx], houses[houseIdx]->getTotalDirt());
+        record(taskIdx, calculateScore(result, maxSteps[houseIdx], houses[houseIdx]->getTotalDirt()), false,
+               {0, 0, 0});
+    };
+    auto replace = [&](WorkerProcess& process, const std::string& reason) {
+        closeWorkerFds(process);
+        int status = 0;
+        waitpid(process.pid, &status, 0);
+        fail(process.task, reason.empty() ? describeExit(status) : reason);
+        process.pid = -1;
+        process.task = -1;
+        if (!spawn(process)) {
+            std::cerr << "Error: Could not start a worker process: " << std::strerror(errno) << std::endl;
         }
     };
 
-    for (int i = 0; i < numThreads; ++i) {
-        threads.emplace_back(worker);
+    for (auto& process : processes) {
+        if (!spawn(process)) {
+            std::cerr << "Error: Could not start a worker process: " << std::strerror(errno) << std::endl;
+        }
     }
 
-    for (auto& thread : threads) {
-        thread.join();
+    size_t next = 0;
+    size_t done = 0;
+    while (done < tasks.size()) {
+        auto now = std::chrono::steady_clock::now();
+        bool anyAlive = false;
+        for (auto& process : processes) {
+            if (process.pid < 0) {
+                continue;
+            }
+            anyAlive = true;
+            if (process.task >= 0 || next >= tasks.size()) {
+                continue;
+            }
+            auto [houseIdx, algoIdx] = tasks[next];
+            ProcessTask task{static_cast<std::uint32_t>(houseIdx), static_cast<std::uint32_t>(algoIdx),
+                             pruneThreshold(best[houseIdx])};
+            process.task = static_cast<long>(next++);
+            // A hung run is given a few times its own time limit before its worker is killed
+            process.deadline = now + std::chrono::milliseconds(kHangFactor * maxSteps[houseIdx] + 1000);
+            // If the worker is gone the write fails; the closed result pipe reports it below
+            writeFull(process.taskFd, &task, sizeof(task));
+        }
+        if (!anyAlive) {
+            for (; next < tasks.size(); ++next, ++done) {
+                fail(next, "no worker process left");
+            }
+            break;
+        }
+
+        std::vector<pollfd> fds;
+        std::vector<WorkerProcess*> polled;
+        auto wait = std::chrono::milliseconds::max();
+        for (auto& process : processes) {
+            if (process.pid >= 0 && process.task >= 0) {
+                fds.push_back({process.resultFd, POLLIN, 0});
+                polled.push_back(&process);
+                wait = std::min(wait, std::chrono::duration_cast<std::chrono::milliseconds>(process.deadline - now));
+            }
+        }
+        if (fds.empty()) {
+            continue;
+        }
+        int timeout = static_cast<int>(std::clamp<long long>(wait.count() + 1, 0, INT_MAX));
+        int ready = poll(fds.data(), fds.size(), timeout);
+        if (ready < 0 && errno != EINTR) {
+            std::cerr << "Error: poll failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < polled.size(); ++i) {
+            WorkerProcess& process = *polled[i];
+            if (ready > 0 && fds[i].revents != 0) {
+                ProcessResult result;
+                if (readFull(process.resultFd, &result, sizeof(result))) {
+                    record(process.task, result.score, result.pruned != 0,
+                           {result.arenaBytes, result.wallMs, result.cpuMs});
+                    process.task = -1;
+                } else {
+                    replace(process, "");
+                }
+                ++done;
+            } else if (now >= process.deadline) {
+                kill(process.pid, SIGKILL);
+                replace(process, "did not finish within " + std::to_string(kHangFactor) + " times its time limit");
+                ++done;
+            }
+        }
+    }
+
+    // Closing the task pipes lets the workers exit
+    for (auto& process : processes) {
+        if (process.pid >= 0) {
+            closeWorkerFds(process);
+            waitpid(process.pid, nullptr, 0);
+        }
+    }
+    std::signal(SIGPIPE, previousSigpipe);
+}
+
+// Body of a worker process: run the tasks read from taskFd until it is closed, then exit without running the
+// simulator's own cleanup, which belongs to the parent
+void Simulation::runWorkerProcess(int taskFd, int resultFd, const std::vector<std::pair<std::string, std::function<std::unique_ptr<AbstractAlgorithm>()>>>& algorithms, bool summaryOnly) {
+    Worker worker;
+    ProcessTask task;
+    while (readFull(taskFd, &task, sizeof(task))) {
+        const House& house = houseFor(worker, *houses[task.house]);
+        const auto& [algoName, algoFactory] = algorithms[task.algorithm];
+        ProcessResult report{};
+        runOnWorker(worker, task.algorithm, algoFactory, house, maxSteps[task.house], maxBatteries[task.house],
+                    task.pruneAbove, [&](SimulationResult& result) {
+            if (!summaryOnly) {
+                writeOutputFile(house.getName(), algoName, result);
+            }
+            report.steps = result.steps;
+            report.dirtLeft = result.dirtLeft;
+            report.score = result.score;
+            report.finished = result.finished;
+            report.inDock = result.inDock;
+            report.pruned = result.pruned;
+            report.arenaBytes = result.arenaBytes;
+            report.wallMs = result.wallMs;
+            report.cpuMs = result.cpuMs;
+        });
+        std::cout.flush();
+        if (!writeFull(resultFd, &report, sizeof(report))) {
+            break;
+        }
     }
+    std::cout.flush();
+    _exit(0);
 }
 
-void Simulation::runSingleSimulation(const House& house, std::unique_ptr<AbstractAlgorithm> algo, 
-                                     const std::string& algoName, int maxSteps, int maxBattery, bool summaryOnly) {
-    House simHouse = house; // Create a copy of the house for this simulation
-    int initialDirt = simHouse.getTotalDirt();
+// Simulate and score one run; a run taking longer than maxSteps milliseconds on the timeout clock scores as if it
+// never finished
+Simulation::SimulationResult Simulation::runScored(House& house, AbstractAlgorithm& algo, int maxSteps, int maxBattery,
+                                                   int pruneAbove, std::pmr::memory_resource* resource) {
+    int initialDirt = house.getTotalDirt();
 
-    auto start = std::chrono::high_resolution_clock::now();
-    auto result = simulateAlgorithm(simHouse, *algo, maxSteps, maxBattery);
-    auto end = std::chrono::high_resolution_clock::now();
+    auto start = std::chrono::steady_clock::now();
+    auto cpuStart = threadCpuTime();
+    auto result = simulateAlgorithm(house, algo, maxSteps, maxBattery, pruneAbove, resource);
+    std::chrono::duration<double, std::milli> cpu = threadCpuTime() - cpuStart;
+    std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - start;
+    result.wallMs = wall.count();
+    result.cpuMs = cpu.count();
 
-    std::chrono::duration<double, std::milli> elapsed = end - start;
+    auto elapsed = timeoutClock == TimeoutClock::Cpu ? cpu : wall;
     if (elapsed > std::chrono::milliseconds(maxSteps)) {
-        result.steps = maxSteps;
-        result.finished = false;
-        result.dirtLeft = initialDirt;
-        result.inDock = false;
+        markTimedOut(result, maxSteps, initialDirt);
     }
 
-    result.score = calculateScore(result, maxSteps, initialDirt);
+    if (result.cycling) {
+        // Scored as the run it would be if it never got out of the circle
+        SimulationResult exhausted;
+        markTimedOut(exhausted, maxSteps, initialDirt);
+        result.prunedScore = calculateScore(exhausted, maxSteps, initialDirt);
+    }
+    result.score = result.pruned ? result.prunedScore : calculateScore(result, maxSteps, initialDirt);
+    return result;
+}
 
-    {
-        std::lock_guard<std::mutex> lock(scoresMutex);
-        scores[{house.getName(), algoName}] = result.score;
+void Simulation::markTimedOut(SimulationResult& result, int maxSteps, int initialDirt) {
+    result.steps = maxSteps;
+    result.finished = false;
+    result.dirtLeft = initialDirt;
+    result.inDock = false;
+    result.pruned = false;
+    result.cycling = false;
+}
+
+void Simulation::setQuiet(bool enabled) {
+    quiet = enabled;
+}
+
+void Simulation::setTimeoutClock(TimeoutClock clock) {
+    timeoutClock = clock;
+}
+
+void Simulation::setPruning(const PruneOptions& options) {
+    pruning = options;
+}
+
+// Score above which a run may stop, given the best score another algorithm got on the same task
+int Simulation::pruneThreshold(int bestSoFar) const {
+    return pruning.enabled ? std::min(pruning.threshold, bestSoFar) : INT_MAX;
+}
+
+int Simulation::rankingScore(const SimulationResult& result) {
+    return result.pruned ? INT_MAX : result.score;
+}
+
+void Simulation::runVariants(const std::vector<std::pair<std::string, std::function<std::unique_ptr<AbstractAlgorithm>()>>>& algorithms, int numThreads, int variants, std::uint64_t seed) {
+    std::vector<Worker> workers(numThreads);
+    runTasks(houses.size() * static_cast<size_t>(variants), numThreads,
+             [this, &algorithms, &workers, variants, seed](size_t worker, size_t index) {
+        // Every (house, variant) pair gets its own stream, so the variants do not depend on the thread count
+        size_t houseIdx = index / variants;
+        size_t variant = index % variants;
+        std::seed_seq seq{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32),
+                          static_cast<std::uint32_t>(houseIdx), static_cast<std::uint32_t>(variant)};
+        std::mt19937_64 rng(seq);
+        const House variantHouse = houses[houseIdx]->makeDirtVariant(rng);
+
+        int best = INT_MAX;
+        for (size_t algoIdx = 0; algoIdx < algorithms.size(); ++algoIdx) {
+            const auto& [algoName, algoFactory] = algorithms[algoIdx];
+            runOnWorker(workers[worker], algoIdx, algoFactory, variantHouse, maxSteps[houseIdx],
+                        maxBatteries[houseIdx], pruneThreshold(best), [&](SimulationResult& result) {
+                best = std::min(best, rankingScore(result));
+                std::lock_guard<std::mutex> lock(scoresMutex);
+                variantSamples[{algoName, variantHouse.getName()}].push_back({result.score, result.steps});
+            });
+        }
+    });
+}
+
+void Simulation::runSweep(const std::vector<std::pair<std::string, std::function<std::unique_ptr<AbstractAlgorithm>()>>>& algorithms, int numThreads, const SweepRange& batteries, const SweepRange& steps) {
+    // The grid of each house: its own value stands in for a range that was not given
+    std::vector<std::vector<std::pair<int, int>>> grids;
+    for (size_t houseIdx = 0; houseIdx < houses.size(); ++houseIdx) {
+        std::vector<std::pair<int, int>> grid;
+        for (int battery : batteries.values(maxBatteries[houseIdx])) {
+            for (int stepLimit : steps.values(maxSteps[houseIdx])) {
+                grid.emplace_back(battery, stepLimit);
+            }
+        }
+        grids.push_back(std::move(grid));
+    }
+    std::vector<std::pair<size_t, size_t>> tasks; // (house, grid point)
+    for (size_t houseIdx = 0; houseIdx < houses.size(); ++houseIdx) {
+        for (size_t point = 0; point < grids[houseIdx].size(); ++point) {
+            tasks.emplace_back(houseIdx, point);
+        }
     }
 
-    if (!summaryOnly) {
-        writeOutputFile(house.getName(), algoName, result);
+    std::vector<Worker> workers(numThreads);
+    runTasks(tasks.size(), numThreads, [this, &algorithms, &workers, &grids, &tasks](size_t worker, size_t index) {
+        auto [houseIdx, point] = tasks[index];
+        auto [battery, stepLimit] = grids[houseIdx][point];
+        const House& house = houseFor(workers[worker], *houses[houseIdx]);
+        int best = INT_MAX;
+        for (size_t algoIdx = 0; algoIdx < algorithms.size(); ++algoIdx) {
+            const auto& [algoName, algoFactory] = algorithms[algoIdx];
+            runOnWorker(workers[worker], algoIdx, algoFactory, house, stepLimit, battery,
+                        pruneThreshold(best), [&](SimulationResult& result) {
+                best = std::min(best, rankingScore(result));
+                result.stepsString.clear();
+                // A copy, so that the row does not keep memory of the arena
+                std::lock_guard<std::mutex> lock(scoresMutex);
+                sweepRows.push_back({houses[houseIdx]->getName(), algoName, battery, stepLimit, result});
+            });
+        }
+    });
+}
+
+namespace {
+// Decides when a run may stop before it ends, see Simulation::PruneOptions
+class RunPruner {
+public:
+    RunPruner(const House& house, int pruneAbove, std::pmr::memory_resource* resource)
+        : cols(house.getCols()), pruneAbove(pruneAbove), dockDistances(house.getDockDistances()),
+          visited(static_cast<size_t>(house.getRows()) * house.getCols(), false, resource), seen(resource) {
+        markVisited(house.getDockingStation());
     }
+
+    // The final score cannot be lower than this: every unit of dirt left costs a step to clean or 300 to leave,
+    // and being away from the dock costs the way back or the 1000 penalty. It never decreases during a run.
+    int scoreLowerBound(int steps, int dirtLeft, const Position& pos) const {
+        int back = std::max(dockDistances[index(pos)], 0);
+        return steps + dirtLeft + std::min(back, 1000);
+    }
+
+    // Configurations (position, battery) seen since the robot last cleaned or reached a new cell. Seeing one
+    // kCycleRepeats times means the algorithm keeps going round without getting anywhere.
+    bool isCycling(const Position& pos, std::size_t battery, int dirtLeft) {
+        if (dirtLeft != lastDirtLeft || markVisited(pos)) {
+            lastDirtLeft = dirtLeft;
+            seen.clear();
+        }
+        return ++seen[(static_cast<std::uint64_t>(index(pos)) << 32) | battery] >= kCycleRepeats;
+    }
+
+    // Returns the score bound to report if the run should stop now, or -1 to go on. cycling tells whether it
+    // stops for going round in circles rather than for its score.
+    int check(int steps, int dirtLeft, const Position& pos, std::size_t battery, bool& cycling) {
+        cycling = false;
+        int bound = scoreLowerBound(steps, dirtLeft, pos);
+        if (bound > pruneAbove) {
+            return bound;
+        }
+        if (isCycling(pos, battery, dirtLeft)) {
+            cycling = true;
+            return bound;
+        }
+        return -1;
+    }
+
+private:
+    static constexpr int kCycleRepeats = 32;
+
+    size_t index(const Position& pos) const { return static_cast<size_t>(pos.r) * cols + pos.c; }
+
+    // Returns true the first time pos is visited
+    bool markVisited(const Position& pos) {
+        if (visited[index(pos)]) {
+            return false;
+        }
+        visited[index(pos)] = true;
+        return true;
+    }
+
+    int cols;
+    int pruneAbove;
+    const std::vector<int>& dockDistances; // shared by every run on the house, see House::getDockDistances
+    std::pmr::vector<bool> visited;
+    int lastDirtLeft = -1;
+    std::pmr::unordered_map<std::uint64_t, int> seen;
+};
 }
 
 Simulation::SimulationResult Simulation::simulateAlgorithm(House& house, AbstractAlgorithm& algo, 
-                                                           int maxSteps, int maxBattery) {
-    SimulationResult result{};
+                                                           int maxSteps, int maxBattery, int pruneAbove,
+                                                           std::pmr::memory_resource* resource) {
+    SimulationResult result{.stepsString = std::pmr::string(resource)};
     result.dirtLeft = house.getTotalDirt();
     result.inDock = true;
 
     Vacuum vacuum;
     vacuum.init(maxBattery, house.getDockingStation());
     SensorImpl sensor(house, maxBattery);
+    house.setQuiet(quiet);
+    sensor.setQuiet(quiet);
 
     algo.setMaxSteps(maxSteps);
     algo.setWallsSensor(sensor);
     algo.setDirtSensor(sensor);
     algo.setBatteryMeter(sensor);
+    if (auto* snapshotReader = dynamic_cast<SnapshotAlgorithm*>(&algo)) {
+        snapshotReader->setSensorSnapshot(sensor.snapshot(), sensor.getMaxBattery());
+    }
 
-    Step step;
+    Step step = Step::Stay;
+    auto* batched = dynamic_cast<BatchedAlgorithm*>(&algo);
+    std::unique_ptr<RunPruner> pruner;
+    if (pruning.enabled) {
+        pruner = std::make_unique<RunPruner>(house, pruneAbove, resource);
+    }
+    auto prune = [&]() {
+        if (!pruner || result.finished) {
+            return false;
+        }
+        bool cycling = false;
+        int score = pruner->check(result.steps, result.dirtLeft, vacuum.getPosition(), sensor.getBatteryState(),
+                                  cycling);
+        if (score < 0) {
+            return false;
+        }
+        result.pruned = true;
+        result.cycling = cycling;
+        result.prunedScore = score; // runScored scores a cycling run
+        return true;
+    };
 
     while (result.steps < maxSteps && !result.finished) {
-        if(house.isHouseClean() && result.inDock) {
-            result.finished = true;
-            result.stepsString+= stepToString(Step::Finish);
-            std::cout << "House is clean, simulation finished" << std::endl;
+        if (finishIfClean(house, result)) {
             break;
         }
+        if (batched) {
+            BatchTrigger triggers = BatchTrigger::None;
+            std::span<const Step> batch = batched->nextSteps(triggers);
+            if (!batch.empty()) {
+                std::size_t applied = 0;
+                while (applied < batch.size() && result.steps < maxSteps && !result.finished &&
+                       !(house.isHouseClean() && result.inDock)) {
+                    step = batch[applied++];
+                    applyStep(house, vacuum, sensor, step, result);
+                    if (prune()) {
+                        break;
+                    }
+                    if ((hasTrigger(triggers, BatchTrigger::Dirt) && sensor.dirtLevel() > 0) ||
+                        (hasTrigger(triggers, BatchTrigger::BatteryFull) &&
+                         sensor.getBatteryState() == sensor.getMaxBattery())) {
+                        break;
+                    }
+                }
+                batched->stepsConsumed(applied);
+                if (result.pruned) {
+                    break;
+                }
+                continue;
+            }
+        }
         step = algo.nextStep();
-        result.stepsString += stepToString(step);
+        applyStep(house, vacuum, sensor, step, result);
+        if (prune()) {
+            break;
+        }
+    }
+    if(result.inDock && step == Step::Finish)
+    {
+        result.stepsString += stepToString(Step::Finish);
+    }
+    return result;
+}
 
-        vacuum.step(step);
-        sensor.updatePosition(step);
-        result.inDock = vacuum.atDockingStation();
+// Apply recorded steps the way simulateAlgorithm applies the ones an algorithm returns
+Simulation::SimulationResult Simulation::replaySteps(House& house, const std::string& steps, int maxSteps,
+                                                     int maxBattery) const {
+    SimulationResult result{};
+    result.dirtLeft = house.getTotalDirt();
+    result.inDock = true;
+    result.stepsString.reserve(steps.size());
 
-        Position currentPos = vacuum.getPosition();
-        std::cout << "currentPos: " << currentPos.r << ", " << currentPos.c << std::endl;
-        if (step == Step::Stay) {
-            if (house.getDirtLevel(currentPos) > 0) {
-                house.cleanCell(currentPos);
-                sensor.useBattery();
-                result.dirtLeft = house.getTotalDirt();
+    Vacuum vacuum;
+    vacuum.init(maxBattery, house.getDockingStation());
+    SensorImpl sensor(house, maxBattery);
+    house.setQuiet(quiet);
+    sensor.setQuiet(quiet);
+
+    Step step = Step::Stay;
+    for (char c : steps) {
+        if (result.steps >= maxSteps || result.finished || finishIfClean(house, result) || !stepFromChar(c, step)) {
+            break;
+        }
+        applyStep(house, vacuum, sensor, step, result);
+    }
+    if (result.inDock && step == Step::Finish) {
+        result.stepsString += stepToString(Step::Finish);
+    }
+    return result;
+}
+
+namespace {
+// The result and steps stored in a <house>-<algo>.txt file, see Simulation::writeOutputFile
+struct StoredTrace {
+    int steps = -1;
+    int dirtLeft = -1;
+    std::string status;
+    bool inDock = false;
+    int score = -1;
+    std::string stepsString;
+};
+
+bool readTrace(const fs::path& path, StoredTrace& trace) {
+    std::ifstream in(path);
+    std::string line;
+    auto trim = [](std::string& text) {
+        if (!text.empty() && text.back() == '\r') {
+            text.pop_back();
+        }
+    };
+    while (std::getline(in, line)) {
+        trim(line);
+        if (line == "Steps:") {
+            std::getline(in, trace.stepsString);
+            trim(trace.stepsString);
+            return trace.steps >= 0 && trace.dirtLeft >= 0 && !trace.status.empty() && trace.score >= 0;
+        }
+        size_t eq = line.find(" = ");
+        if (eq == std::string::npos) {
+            return false;
+        }
+        std::string key = line.substr(0, eq);
+        std::string value = line.substr(eq + 3);
+        try {
+            if (key == "NumSteps") {
+                trace.steps = std::stoi(value);
+            } else if (key == "DirtLeft") {
+                trace.dirtLeft = std::stoi(value);
+            } else if (key == "Status") {
+                trace.status = value;
+            } else if (key == "InDock") {
+                trace.inDock = value == "TRUE";
+            } else if (key == "Score") {
+                trace.score = std::stoi(value);
             }
-            if (result.inDock) {
-                sensor.chargeBattery();
-                vacuum.setBattery(sensor.getBatteryState());
+        } catch (const std::exception& e) {
+            return false;
+        }
+    }
+    return false;
+}
+}
+
+Simulation::ReplayStats Simulation::replayTraces(const std::string& tracePath, int numThreads, bool rewrite) {
+    // Traces are named <house>-<algo>.txt; a house name may contain '-' itself, so the longest one that fits wins
+    std::map<std::string, size_t> houseIndex;
+    for (size_t houseIdx = 0; houseIdx < houses.size(); ++houseIdx) {
+        houseIndex.emplace(houses[houseIdx]->getName(), houseIdx);
+    }
+    std::vector<std::tuple<fs::path, size_t, std::string>> traces; // (file, house, algoName)
+    for (const auto& entry : fs::directory_iterator(tracePath)) {
+        if (entry.path().extension() != ".txt") {
+            continue;
+        }
+        std::string stem = entry.path().stem().string();
+        for (size_t dash = stem.rfind('-'); dash != std::string::npos && dash > 0; dash = stem.rfind('-', dash - 1)) {
+            auto it = houseIndex.find(stem.substr(0, dash));
+            if (it != houseIndex.end()) {
+                traces.emplace_back(entry.path(), it->second, stem.substr(dash + 1));
+                break;
             }
         }
-        if (step !=Step::Stay && !result.inDock) {
-            sensor.useBattery();
+    }
+
+    ReplayStats stats;
+    runTasks(traces.size(), numThreads, [this, &traces, &stats, rewrite](size_t, size_t index) {
+        const auto& [path, houseIdx, algoName] = traces[index];
+        StoredTrace stored;
+        if (!readTrace(path, stored)) {
+            std::lock_guard<std::mutex> lock(scoresMutex);
+            std::cerr << "Skipping " << path << ": not a step trace" << std::endl;
+            return;
         }
+        House simHouse = *houses[houseIdx];
+        int initialDirt = simHouse.getTotalDirt();
+        auto result = replaySteps(simHouse, stored.stepsString, maxSteps[houseIdx], maxBatteries[houseIdx]);
 
-        if (step == Step::Finish) {
-            result.finished = true;
+        // Wall-clock timeouts and pruning leave no mark in the steps, so they are taken from the stored result
+        if (stored.steps >= maxSteps[houseIdx] && result.steps < maxSteps[houseIdx]) {
+            markTimedOut(result, maxSteps[houseIdx], initialDirt);
+        }
+        if (stored.status == "PRUNED" || stored.status == "CYCLING") {
+            result.pruned = true;
+            result.cycling = stored.status == "CYCLING";
+            result.prunedScore = stored.score;
         }
+        result.score = result.pruned ? result.prunedScore
+                                     : calculateScore(result, maxSteps[houseIdx], initialDirt);
 
-        result.steps++;
+        const std::string& houseName = houses[houseIdx]->getName();
+        if (rewrite) {
+            writeOutputFile(houseName, algoName, result);
+        }
+        bool changed = result.steps != stored.steps || result.dirtLeft != stored.dirtLeft ||
+                       statusToString(result) != stored.status || result.inDock != stored.inDock ||
+                       result.score != stored.score;
+
+        std::lock_guard<std::mutex> lock(scoresMutex);
+        scores[{houseName, algoName}] = result.score;
+        stats.traces++;
+        stats.steps += result.steps;
+        if (changed) {
+            stats.changed++;
+            std::cout << path.filename().string() << ": stored NumSteps " << stored.steps << ", DirtLeft "
+                      << stored.dirtLeft << ", Status " << stored.status << ", InDock "
+                      << (stored.inDock ? "TRUE" : "FALSE") << ", Score " << stored.score << "; replayed NumSteps "
+                      << result.steps << ", DirtLeft " << result.dirtLeft << ", Status " << statusToString(result)
+                      << ", InDock " << (result.inDock ? "TRUE" : "FALSE") << ", Score " << result.score
+                      << std::endl;
+        }
+    });
+    return stats;
+}
+
+// The run ends by itself once the house is clean and the vacuum is back in the docking station
+bool Simulation::finishIfClean(const House& house, SimulationResult& result) const {
+    if (!house.isHouseClean() || !result.inDock) {
+        return false;
     }
-    if(result.inDock && step == Step::Finish)
-    {
-        result.stepsString += stepToString(Step::Finish);
+    result.finished = true;
+    result.stepsString += stepToString(Step::Finish);
+    if (!quiet) {
+        std::cout << "House is clean, simulation finished" << std::endl;
     }
-    return result;
+    return true;
+}
+
+// Apply one step to the house, the vacuum and the sensors, and record it in result
+void Simulation::applyStep(House& house, Vacuum& vacuum, SensorImpl& sensor, Step step,
+                           SimulationResult& result) const {
+    result.stepsString += stepToString(step);
+
+    vacuum.step(step);
+    sensor.updatePosition(step);
+    result.inDock = vacuum.atDockingStation();
+
+    Position currentPos = vacuum.getPosition();
+    if (!quiet) {
+        std::cout << "currentPos: " << currentPos.r << ", " << currentPos.c << std::endl;
+    }
+    if (step == Step::Stay) {
+        if (house.getDirtLevel(currentPos) > 0) {
+            house.cleanCell(currentPos);
+            sensor.useBattery();
+            result.dirtLeft = house.getTotalDirt();
+        }
+        if (result.inDock) {
+            sensor.chargeBattery();
+            vacuum.setBattery(sensor.getBatteryState());
+        }
+    }
+    if (step !=Step::Stay && !result.inDock) {
+        sensor.useBattery();
+    }
+
+    if (step == Step::Finish) {
+        result.finished = true;
+    }
+
+    result.steps++;
+    sensor.refreshSnapshot();
 }
 
 int Simulation::calculateScore(const SimulationResult& result, int maxSteps, int initialDirt) const {
@@ -148,12 +1014,19 @@ void Simulation::writeOutputFile(const std::string& houseName, const std::string
     std::ofstream outFile(filename);
     outFile << "NumSteps = " << result.steps << std::endl;
     outFile << "DirtLeft = " << result.dirtLeft << std::endl;
-    outFile << "Status = " << (result.finished ? "FINISHED" : (result.steps >= 1000 ? "WORKING" : "DEAD")) << std::endl;
+    outFile << "Status = " << statusToString(result) << std::endl;
     outFile << "InDock = " << (result.inDock ? "TRUE" : "FALSE") << std::endl;
     outFile << "Score = " << result.score << std::endl;
     outFile << "Steps:\n" << result.stepsString << std::endl;
 }
 
+std::string Simulation::statusToString(const SimulationResult& result) {
+    if (result.pruned) {
+        return result.cycling ? "CYCLING" : "PRUNED";
+    }
+    return result.finished ? "FINISHED" : (result.steps >= 1000 ? "WORKING" : "DEAD");
+}
+
 std::string Simulation::stepToString(Step step) {
     switch (step) {
         case Step::North: return "N";
@@ -165,6 +1038,18 @@ std::string Simulation::stepToString(Step step) {
         default: return "?";
     }
 }
+
+bool Simulation::stepFromChar(char c, Step& step) {
+    switch (c) {
+        case 'N': step = Step::North; return true;
+        case 'S': step = Step::South; return true;
+        case 'E': step = Step::East; return true;
+        case 'W': step = Step::West; return true;
+        case 's': step = Step::Stay; return true;
+        case 'F': step = Step::Finish; return true;
+        default: return false;
+    }
+}
 /*
 void Simulation::generateSummary() const {
     std::cout << "Starting generateSummary()" << std::endl;
@@ -277,4 +1162,139 @@ void Simulation::generateSummary() const {
     } catch (...) {
         std::cerr << "Unknown exception in generateSummary()" << std::endl;
     }
+}
+
+namespace {
+struct SampleStats {
+    double mean = 0;
+    double variance = 0; // sample variance, 0 for a single run
+    int p10 = 0;
+    int p50 = 0;
+    int p90 = 0;
+};
+
+// Nearest-rank percentiles
+SampleStats describe(std::vector<int> values) {
+    SampleStats stats;
+    if (values.empty()) {
+        return stats;
+    }
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    for (int value : values) {
+        sum += value;
+    }
+    stats.mean = sum / values.size();
+    if (values.size() > 1) {
+        double squares = 0;
+        for (int value : values) {
+            squares += (value - stats.mean) * (value - stats.mean);
+        }
+        stats.variance = squares / (values.size() - 1);
+    }
+    auto percentile = [&](int p) {
+        size_t rank = (values.size() * p + 99) / 100;
+        return values[std::max<size_t>(rank, 1) - 1];
+    };
+    stats.p10 = percentile(10);
+    stats.p50 = percentile(50);
+    stats.p90 = percentile(90);
+    return stats;
+}
+
+void writeStats(std::ofstream& out, const SampleStats& stats) {
+    out << "," << stats.mean << "," << stats.variance << "," << stats.p10 << "," << stats.p50 << "," << stats.p90;
+}
+}
+
+void Simulation::generateVariantReport() const {
+    std::ofstream report("variants.csv");
+    if (!report.is_open()) {
+        std::cerr << "Failed to open variants.csv for writing" << std::endl;
+        return;
+    }
+    report << "Algorithm,House,Runs,ScoreMean,ScoreVariance,ScoreP10,ScoreP50,ScoreP90,"
+           << "StepsMean,StepsVariance,StepsP10,StepsP50,StepsP90" << std::endl;
+
+    // One row per house, then one over all houses of the algorithm
+    std::vector<int> allScores, allSteps;
+    for (auto it = variantSamples.begin(); it != variantSamples.end(); ++it) {
+        const auto& [key, samples] = *it;
+        std::vector<int> scoreValues, stepValues;
+        for (const auto& sample : samples) {
+            scoreValues.push_back(sample.score);
+            stepValues.push_back(sample.steps);
+        }
+        allScores.insert(allScores.end(), scoreValues.begin(), scoreValues.end());
+        allSteps.insert(allSteps.end(), stepValues.begin(), stepValues.end());
+        report << key.first << "," << key.second << "," << samples.size();
+        writeStats(report, describe(scoreValues));
+        writeStats(report, describe(stepValues));
+        report << std::endl;
+
+        auto next = std::next(it);
+        if (next == variantSamples.end() || next->first.first != key.first) {
+            report << key.first << ",ALL," << allScores.size();
+            writeStats(report, describe(allScores));
+            writeStats(report, describe(allSteps));
+            report << std::endl;
+            allScores.clear();
+            allSteps.clear();
+        }
+    }
+}
+
+std::vector<int> Simulation::SweepRange::values(int fallback) const {
+    if (!isSet()) {
+        return {fallback};
+    }
+    std::vector<int> result;
+    for (int value = first; value <= last; value += step) {
+        result.push_back(value);
+    }
+    return result;
+}
+
+// One row per run, in a stable order whatever order the workers finished in
+void Simulation::generateSweepReport() {
+    std::sort(sweepRows.begin(), sweepRows.end(), [](const SweepRow& a, const SweepRow& b) {
+        return std::tie(a.houseName, a.algoName, a.maxBattery, a.maxSteps) <
+               std::tie(b.houseName, b.algoName, b.maxBattery, b.maxSteps);
+    });
+    std::ofstream report("sweep.csv");
+    if (!report.is_open()) {
+        std::cerr << "Failed to open sweep.csv for writing" << std::endl;
+        return;
+    }
+    report << "House,Algorithm,MaxBattery,MaxSteps,NumSteps,DirtLeft,Status,InDock,Score,WallMs,CpuMs" << std::endl;
+    for (const auto& row : sweepRows) {
+        report << row.houseName << "," << row.algoName << "," << row.maxBattery << "," << row.maxSteps << ","
+               << row.result.steps << "," << row.result.dirtLeft << "," << statusToString(row.result) << ","
+               << (row.result.inDock ? "TRUE" : "FALSE") << "," << row.result.score << "," << row.result.wallMs
+               << "," << row.result.cpuMs << std::endl;
+    }
+}
+
+void Simulation::generateMemoryReport() const {
+    std::ofstream report("memory.csv");
+    if (!report.is_open()) {
+        std::cerr << "Failed to open memory.csv for writing" << std::endl;
+        return;
+    }
+    report << "House,Algorithm,ArenaBytes" << std::endl;
+    for (const auto& [key, run] : runRecords) {
+        report << key.first << "," << key.second << "," << run.arenaBytes << std::endl;
+    }
+}
+
+void Simulation::generateTimingReport() const {
+    std::ofstream report("timings.csv");
+    if (!report.is_open()) {
+        std::cerr << "Failed to open timings.csv for writing" << std::endl;
+        return;
+    }
+    report << "House,Algorithm,WallMs,CpuMs" << std::endl;
+    for (const auto& [key, run] : runRecords) {
+        report << key.first << "," << key.second << "," << run.wallMs << "," << run.cpuMs << std::endl;
+    }
 }
\ No newline at end of file
@@ -4,40 +4,204 @@
 #include <vector>
 #include <memory>
 #include <mutex>
+#include <condition_variable>
 #include <atomic>
 #include <map>
+#include <unordered_map>
+#include <cstdint>
+#include <climits>
 #include <functional>  // Add this include for std::function
+#include <memory_resource>
 #include "House.h"
+#include "RunArena.h"
 #include "AbstractAlgorithm.h"
 
+class Vacuum;
+class SensorImpl;
+
 class Simulation {
 public:
     Simulation(std::vector<std::unique_ptr<House>> houses, std::vector<int> maxSteps, std::vector<int> maxBatteries);
+    // No houses yet: they are added with addHouse, also while runSimulations is running, until closeHouses
+    Simulation();
     ~Simulation() = default;
 
+    // Safe to call from another thread while runSimulations runs
+    void addHouse(std::unique_ptr<House> house, int maxSteps, int maxBattery);
+    // No more houses will be added
+    void closeHouses();
+    size_t houseCount();
+
+    // Each worker takes the next house as soon as one is available and runs every algorithm on it; returns once
+    // the houses are closed and all of them have been run. The other run modes need every house added first.
     void runSimulations(const std::vector<std::pair<std::string, std::function<std::unique_ptr<AbstractAlgorithm>()>>>& algorithms, int numThreads, bool summaryOnly);
+    // Same runs and results, but in numProcesses worker processes forked up front with the algorithms already
+    // loaded, so that a run that crashes only takes its worker with it. Runs go to the workers one at a time over
+    // pipes. A worker that dies or hangs is replaced; its run is reported on stderr and in <house>-<algo>.error
+    // and scores as a run that used up all its steps.
+    void runSimulationsInProcesses(const std::vector<std::pair<std::string, std::function<std::unique_ptr<AbstractAlgorithm>()>>>& algorithms, int numProcesses, bool summaryOnly);
     void generateSummary() const;
+    // Run every algorithm on variants randomized variants of each house's dirt, see House::makeDirtVariant.
+    // The variants of a house are derived from seed and exist only in memory; no per-run files are written.
+    void runVariants(const std::vector<std::pair<std::string, std::function<std::unique_ptr<AbstractAlgorithm>()>>>& algorithms, int numThreads, int variants, std::uint64_t seed);
+    // Mean, variance and percentiles of score and steps per algorithm and house, written to variants.csv
+    void generateVariantReport() const;
+
+    // Early termination for runs whose only purpose is ranking. A run stops once its score is certain to be
+    // above the threshold or above the best score another algorithm got on the same house (and variant or sweep
+    // point), or once it keeps repeating a position and battery without cleaning or reaching a new cell.
+    // Runs stopped by the score have status PRUNED and report a lower bound of their score. Runs stopped for
+    // going round in circles have status CYCLING and score as runs that used up all their steps. Only runs that
+    // were not stopped set the best score the others are pruned against.
+    struct PruneOptions {
+        bool enabled = false;
+        int threshold = INT_MAX;
+    };
+    void setPruning(const PruneOptions& options);
+
+    // Values first, first + step, ... up to last; a range that was not given stands for the house's own value
+    struct SweepRange {
+        int first = 0;
+        int last = -1;
+        int step = 1;
+        bool isSet() const { return first <= last; }
+        std::vector<int> values(int fallback) const;
+    };
+    // Run every algorithm on every house for each (MaxBattery, MaxSteps) pair of the two ranges, reusing the
+    // loaded layouts. Results are kept in memory for generateSweepReport instead of one file per run.
+    void runSweep(const std::vector<std::pair<std::string, std::function<std::unique_ptr<AbstractAlgorithm>()>>>& algorithms, int numThreads, const SweepRange& batteries, const SweepRange& steps);
+    // One row per run, written to sweep.csv
+    void generateSweepReport();
+    // Bytes each run of runSimulations took from its worker's arena, written to memory.csv
+    void generateMemoryReport() const;
+    // Wall time and CPU time of the running thread for each run of runSimulations, written to timings.csv
+    void generateTimingReport() const;
+
+    // Clock a run's time limit of one millisecond per MaxStep is measured on. Wall time includes the time the run
+    // was descheduled, so on a busy or oversubscribed machine the same run may or may not time out; the CPU time
+    // of the thread running it does not. Time spent in threads the algorithm starts itself is not counted.
+    enum class TimeoutClock { Wall, Cpu };
+    void setTimeoutClock(TimeoutClock clock);
+
+    // Replay the step traces (<house>-<algo>.txt) found in tracePath on the loaded houses and score them again,
+    // without loading any algorithm. Traces go through the same step and scoring code as live runs, so the
+    // results match what the current simulator would report. Results that differ from the ones stored in a trace
+    // are reported; with rewrite the trace is written again, to the working directory like a live run.
+    struct ReplayStats {
+        size_t traces = 0;
+        size_t steps = 0;
+        size_t changed = 0;
+    };
+    ReplayStats replayTraces(const std::string& tracePath, int numThreads, bool rewrite);
+    // No output per step
+    void setQuiet(bool enabled);
+
+    // Where workers run. With pinWorkers, worker i of a run is bound to the i-th CPU the simulator may use,
+    // wrapping around when there are more workers than CPUs. With localHouses, a worker runs on its own copy of
+    // each house, made on first use by the worker itself; the kernel places memory on the node of the CPU that
+    // first writes it, so together with pinWorkers a worker reads its houses from its own NUMA node instead of
+    // the one the main thread loaded them on.
+    struct PlacementOptions {
+        bool pinWorkers = false;
+        bool localHouses = false;
+    };
+    void setPlacement(const PlacementOptions& options);
+    // One worker per hardware thread, or the old fixed count where the number of hardware threads is unknown
+    static int defaultThreadCount();
 
 private:
     struct SimulationResult {
-        int steps;
-        int dirtLeft;
-        bool finished;
-        bool inDock;
-        int score;
-        std::string stepsString;
+        int steps = 0;
+        int dirtLeft = 0;
+        bool finished = false;
+        bool inDock = false;
+        int score = 0;
+        std::pmr::string stepsString;
+        bool pruned = false;
+        bool cycling = false; // pruned for repeating itself, see PruneOptions
+        int prunedScore = 0;
+        std::size_t arenaBytes = 0; // peak memory of the run, see RunArena::used
+        double wallMs = 0;
+        double cpuMs = 0; // CPU time of the thread the run was on
     };
 
     std::vector<std::unique_ptr<House>> houses;
     std::vector<int> maxSteps;
     std::vector<int> maxBatteries;
     std::map<std::pair<std::string, std::string>, int> scores; // (houseName, algoName) -> score
+    // What was measured on a run of runSimulations besides its score
+    struct RunRecord {
+        std::size_t arenaBytes;
+        double wallMs;
+        double cpuMs;
+    };
+    std::map<std::pair<std::string, std::string>, RunRecord> runRecords; // (houseName, algoName) -> record
+    struct RunSample {
+        int score;
+        int steps;
+    };
+    std::map<std::pair<std::string, std::string>, std::vector<RunSample>> variantSamples; // (algoName, houseName) -> runs
+    struct SweepRow {
+        std::string houseName;
+        std::string algoName;
+        int maxBattery;
+        int maxSteps;
+        SimulationResult result;
+    };
+    std::vector<SweepRow> sweepRows;
     std::mutex scoresMutex;
+    std::mutex housesMutex; // guards houses, maxSteps and maxBatteries while houses are added
+    std::condition_variable housesAdded;
+    bool housesClosed = true;
+    PruneOptions pruning;
+    PlacementOptions placement;
+    TimeoutClock timeoutClock = TimeoutClock::Wall;
+    bool quiet = false;
+
+    // Instances a worker thread ran before, kept for its next run of the same algorithm if they can be reset
+    // (see ResettableAlgorithm); a worker owns its pool, so no locking is needed
+    class AlgorithmPool {
+    public:
+        std::unique_ptr<AbstractAlgorithm> acquire(size_t algoIdx,
+                                                   const std::function<std::unique_ptr<AbstractAlgorithm>()>& factory);
+        void release(size_t algoIdx, std::unique_ptr<AbstractAlgorithm> algo);
+    private:
+        std::vector<std::unique_ptr<AbstractAlgorithm>> idle; // algorithm index -> reset instance
+    };
+    // What a worker thread keeps from one run to the next
+    struct Worker {
+        RunArena arena; // declared first, since the pooled instances may hold memory from it
+        AlgorithmPool algorithms;
+        std::unordered_map<const House*, std::unique_ptr<House>> localHouses; // loaded -> copy, see PlacementOptions
+    };
 
-    void runSingleSimulation(const House& house, std::unique_ptr<AbstractAlgorithm> algo, 
-                             const std::string& algoName, int maxSteps, int maxBattery, bool summaryOnly);
-    SimulationResult simulateAlgorithm(House& house, AbstractAlgorithm& algo, int maxSteps, int maxBattery);
+    void runOnWorker(Worker& worker, size_t algoIdx,
+                     const std::function<std::unique_ptr<AbstractAlgorithm>()>& factory, const House& house,
+                     int maxSteps, int maxBattery, int pruneAbove, const std::function<void(SimulationResult&)>& consume);
+    int runSingleSimulation(Worker& worker, size_t algoIdx,
+                            const std::function<std::unique_ptr<AbstractAlgorithm>()>& factory, const House& house,
+                            const std::string& algoName, int maxSteps, int maxBattery, bool summaryOnly,
+                            int pruneAbove);
+    const House& houseFor(Worker& worker, const House& house) const;
+    void runWorkers(int numThreads, const std::function<void(size_t)>& body) const;
+    void runTasks(size_t count, int numThreads, const std::function<void(size_t, size_t)>& task) const;
+    [[noreturn]] void runWorkerProcess(int taskFd, int resultFd, const std::vector<std::pair<std::string, std::function<std::unique_ptr<AbstractAlgorithm>()>>>& algorithms, bool summaryOnly);
+    // A worker process is killed once its run takes this many times the run's time limit
+    static constexpr int kHangFactor = 4;
+    int pruneThreshold(int bestSoFar) const;
+    // The score a run offers to pruneThreshold; a pruned run's score is not its real one, so it offers INT_MAX
+    static int rankingScore(const SimulationResult& result);
+    SimulationResult runScored(House& house, AbstractAlgorithm& algo, int maxSteps, int maxBattery, int pruneAbove,
+                               std::pmr::memory_resource* resource);
+    SimulationResult simulateAlgorithm(House& house, AbstractAlgorithm& algo, int maxSteps, int maxBattery,
+                                       int pruneAbove, std::pmr::memory_resource* resource);
+    SimulationResult replaySteps(House& house, const std::string& steps, int maxSteps, int maxBattery) const;
+    bool finishIfClean(const House& house, SimulationResult& result) const;
+    void applyStep(House& house, Vacuum& vacuum, SensorImpl& sensor, Step step, SimulationResult& result) const;
+    static void markTimedOut(SimulationResult& result, int maxSteps, int initialDirt);
     int calculateScore(const SimulationResult& result, int maxSteps, int initialDirt) const;
     void writeOutputFile(const std::string& houseName, const std::string& algoName, const SimulationResult& result) const;
     static std::string stepToString(Step step);
+    static bool stepFromChar(char c, Step& step);
+    static std::string statusToString(const SimulationResult& result);
 };
\ No newline at end of file
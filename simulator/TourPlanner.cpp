@@ -0,0 +1,249 @@
+#include "TourPlanner.h"
+#include <algorithm>
+#include <functional>
+#include <tuple>
+
+namespace {
+// Cells a distance search settles between two looks at the clock
+constexpr std::size_t kSearchChunk = 4096;
+}
+
+TourPlanner::TourPlanner(const Explorer &explorer)
+    : explorer_(explorer), nodes_(explorer.getMemoryResource()), dirt_(explorer.getMemoryResource()),
+      demand_(explorer.getMemoryResource()), distances_(explorer.getMemoryResource()),
+      routes_(explorer.getMemoryResource()), route_costs_(explorer.getMemoryResource()) {
+}
+
+void TourPlanner::reset(const Position &dock, const std::vector<TourStop> &stops, int capacity) {
+    clear();
+    capacity_ = capacity;
+    nodes_.push_back(dock);
+    dirt_.push_back(0);
+    for (const auto &stop : stops) {
+        nodes_.push_back(stop.pos);
+        dirt_.push_back(stop.demand);
+    }
+    passable_ = explorer_.getPassableGrid(field_);
+    distances_.assign(nodes_.size() * nodes_.size(), -1);
+    startSearch();
+    phase_ = Phase::Distances;
+}
+
+void TourPlanner::clear() {
+    phase_ = Phase::Idle;
+    search_ = DistanceSearch();
+    std::pmr::memory_resource *resource = explorer_.getMemoryResource();
+    if (!resource->is_equal(*nodes_.get_allocator().resource())) {
+        rebuildOnResource(nodes_, resource);
+        rebuildOnResource(dirt_, resource);
+        rebuildOnResource(demand_, resource);
+        rebuildOnResource(distances_, resource);
+        rebuildOnResource(routes_, resource);
+        rebuildOnResource(route_costs_, resource);
+    }
+    nodes_.clear();
+    dirt_.clear();
+    demand_.clear();
+    passable_ = BitGrid();
+    field_ = DistanceField();
+    distances_.clear();
+    distance_rows_ = 0;
+    routes_.clear();
+    route_costs_.clear();
+    two_opt_route_ = 0;
+    two_opt_changed_ = false;
+}
+
+// Every call makes some progress, even when the deadline has already passed. A distance search can span calls, so
+// a call takes at most one chunk of it past the deadline.
+bool TourPlanner::advance(Clock::time_point deadline) {
+    bool first = true;
+    while (phase_ != Phase::Idle && phase_ != Phase::Done && (first || Clock::now() < deadline)) {
+        first = false;
+        switch (phase_) {
+            case Phase::Distances: {
+                if (!search_.expand(kSearchChunk)) {
+                    break;
+                }
+                field_.distances = search_.takeDistances();
+                for (std::size_t to = 0; to < nodes_.size(); ++to) {
+                    distances_[distance_rows_ * nodes_.size() + to] = field_.at(nodes_[to]);
+                }
+                if (++distance_rows_ == nodes_.size()) {
+                    phase_ = Phase::Savings;
+                } else {
+                    startSearch();
+                }
+                break;
+            }
+            case Phase::Savings:
+                buildSavings();
+                phase_ = Phase::TwoOpt;
+                break;
+            case Phase::TwoOpt:
+                if (two_opt_route_ == routes_.size()) {
+                    if (!two_opt_changed_) {
+                        phase_ = Phase::Done;
+                        break;
+                    }
+                    two_opt_route_ = 0;
+                    two_opt_changed_ = false;
+                }
+                if (improveRoute(routes_[two_opt_route_])) {
+                    route_costs_[two_opt_route_] = routeCost(routes_[two_opt_route_]);
+                    two_opt_changed_ = true;
+                }
+                ++two_opt_route_;
+                break;
+            default:
+                break;
+        }
+    }
+    return isReady();
+}
+
+bool TourPlanner::isReady() const {
+    return phase_ == Phase::TwoOpt || phase_ == Phase::Done;
+}
+
+bool TourPlanner::isImproved() const {
+    return phase_ == Phase::Done;
+}
+
+int TourPlanner::getCapacity() const {
+    return capacity_;
+}
+
+std::size_t TourPlanner::getTripCount() const {
+    return isReady() ? routes_.size() : 0;
+}
+
+std::vector<TourStop> TourPlanner::getTrip(std::size_t trip) const {
+    std::vector<TourStop> stops;
+    for (int node : routes_[trip]) {
+        stops.push_back({nodes_[node], demand_[node]});
+    }
+    return stops;
+}
+
+int TourPlanner::getTripCost(std::size_t trip) const {
+    return route_costs_[trip];
+}
+
+int TourPlanner::getTripDemand(std::size_t trip) const {
+    int demand = 0;
+    for (int node : routes_[trip]) {
+        demand += demand_[node];
+    }
+    return demand;
+}
+
+// Search the distances from the node of the next row of distances_; a node off the known map reaches nothing
+void TourPlanner::startSearch() {
+    const Position &from = nodes_[distance_rows_];
+    search_ = DistanceSearch(passable_, {from.r - field_.origin.r, from.c - field_.origin.c});
+}
+
+int TourPlanner::distance(int from, int to) const {
+    return distances_[static_cast<std::size_t>(from) * nodes_.size() + to];
+}
+
+int TourPlanner::routeCost(const std::pmr::vector<int> &route) const {
+    int cost = 0;
+    int prev = 0;
+    for (int node : route) {
+        cost += distance(prev, node) + demand_[node];
+        prev = node;
+    }
+    return cost + distance(prev, 0);
+}
+
+// Start with one trip per stop, then join the ends of two trips in order of the steps saved by not going
+// through the docking station in between, as long as the joined trip fits in capacity
+void TourPlanner::buildSavings() {
+    int count = static_cast<int>(nodes_.size());
+    demand_.assign(count, 0);
+    std::pmr::vector<int> route_of(count, -1, demand_.get_allocator());
+    for (int node = 1; node < count; ++node) {
+        int home = distance(0, node);
+        if (home < 0) {
+            continue;
+        }
+        demand_[node] = std::min(dirt_[node], capacity_ - 2 * home);
+        if (demand_[node] <= 0) {
+            continue;
+        }
+        route_of[node] = static_cast<int>(routes_.size());
+        routes_.push_back({node});
+        route_costs_.push_back(2 * home + demand_[node]);
+    }
+
+    std::pmr::vector<std::tuple<int, int, int>> savings(demand_.get_allocator());
+    for (int i = 1; i < count; ++i) {
+        for (int j = i + 1; j < count; ++j) {
+            if (route_of[i] < 0 || route_of[j] < 0 || distance(i, j) < 0) {
+                continue;
+            }
+            int saving = distance(0, i) + distance(0, j) - distance(i, j);
+            if (saving > 0) {
+                savings.emplace_back(saving, i, j);
+            }
+        }
+    }
+    std::sort(savings.begin(), savings.end(), std::greater<>());
+
+    for (const auto &[saving, i, j] : savings) {
+        int a = route_of[i];
+        int b = route_of[j];
+        if (a == b || route_costs_[a] + route_costs_[b] - saving > capacity_) {
+            continue;
+        }
+        auto &first = routes_[a];
+        auto &second = routes_[b];
+        if ((first.front() != i && first.back() != i) || (second.front() != j && second.back() != j)) {
+            continue;
+        }
+        // Joined as ... i, j ...
+        if (first.back() != i) {
+            std::reverse(first.begin(), first.end());
+        }
+        if (second.front() != j) {
+            std::reverse(second.begin(), second.end());
+        }
+        for (int node : second) {
+            route_of[node] = a;
+        }
+        first.insert(first.end(), second.begin(), second.end());
+        second.clear();
+        route_costs_[a] += route_costs_[b] - saving;
+    }
+
+    std::pmr::vector<std::pmr::vector<int>> routes(routes_.get_allocator());
+    std::pmr::vector<int> costs(route_costs_.get_allocator());
+    for (std::size_t route = 0; route < routes_.size(); ++route) {
+        if (!routes_[route].empty()) {
+            routes.push_back(std::move(routes_[route]));
+            costs.push_back(route_costs_[route]);
+        }
+    }
+    routes_ = std::move(routes);
+    route_costs_ = std::move(costs);
+}
+
+// One pass of 2-opt over a trip, with the docking station at both ends. Returns true if the trip got shorter.
+bool TourPlanner::improveRoute(std::pmr::vector<int> &route) const {
+    bool changed = false;
+    int size = static_cast<int>(route.size());
+    auto at = [&](int index) { return index < 0 || index >= size ? 0 : route[index]; };
+    for (int i = 0; i < size - 1; ++i) {
+        for (int k = i + 1; k < size; ++k) {
+            int before = distance(at(i - 1), at(i)) + distance(at(k), at(k + 1));
+            int after = distance(at(i - 1), at(k)) + distance(at(i), at(k + 1));
+            if (after < before) {
+                std::reverse(route.begin() + i, route.begin() + k + 1);
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,70 @@
+#ifndef VACUUM_FINAL_TOURPLANNER_H
+#define VACUUM_FINAL_TOURPLANNER_H
+
+#include <chrono>
+#include <vector>
+#include "Explorer.h"
+#include "../common/PlannerApi.h"
+
+// A dirty area on a tour and the number of steps spent cleaning it there
+struct TourStop {
+    Position pos;
+    int demand;
+};
+
+// Plans the cleaning of known dirt as trips that start and end at the docking station, each costing at most
+// capacity steps (moves and cleaning). This is a capacitated vehicle routing problem: trips are built with the
+// Clarke-Wright savings heuristic and each trip is then shortened with 2-opt.
+// The work is done in slices that stop at a deadline, so a plan can be spread over several steps; the distance
+// search from one node may itself span several slices. The plan is allocated from the explorer's memory resource,
+// and follows it when the planner is reset or cleared.
+class PLANNER_API TourPlanner {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit TourPlanner(const Explorer &explorer);
+
+    // Drop the current plan and start one for stops. A stop whose dirt does not fit in one trip is only
+    // planned to be cleaned partially, stops that cannot be reached at all are left out.
+    void reset(const Position &dock, const std::vector<TourStop> &stops, int capacity);
+    void clear();
+    // Continue planning until deadline. Returns true once trips are available; 2-opt may still improve them.
+    bool advance(Clock::time_point deadline);
+    bool isReady() const;
+    // No 2-opt move is left that shortens a trip
+    bool isImproved() const;
+    int getCapacity() const;
+
+    std::size_t getTripCount() const;
+    std::vector<TourStop> getTrip(std::size_t trip) const;
+    // Steps the trip takes from leaving the docking station until it is back, cleaning included
+    int getTripCost(std::size_t trip) const;
+    int getTripDemand(std::size_t trip) const;
+
+private:
+    enum class Phase { Idle, Distances, Savings, TwoOpt, Done };
+
+    void startSearch();
+    int distance(int from, int to) const;
+    int routeCost(const std::pmr::vector<int> &route) const;
+    void buildSavings();
+    bool improveRoute(std::pmr::vector<int> &route) const;
+
+    const Explorer &explorer_;
+    Phase phase_ = Phase::Idle;
+    int capacity_ = 0;
+    std::pmr::vector<Position> nodes_; // node 0 is the docking station, then the stops
+    std::pmr::vector<int> dirt_;
+    std::pmr::vector<int> demand_;
+    BitGrid passable_;           // the known map, built once per plan
+    DistanceField field_;        // rectangle of passable_ and the distances from the last node searched
+    DistanceSearch search_;      // distances from nodes_[distance_rows_], over passable_
+    std::pmr::vector<int> distances_; // nodes x nodes, -1 if not reachable
+    std::size_t distance_rows_ = 0;
+    std::pmr::vector<std::pmr::vector<int>> routes_; // node indices of each trip, without the docking station
+    std::pmr::vector<int> route_costs_;
+    std::size_t two_opt_route_ = 0;
+    bool two_opt_changed_ = false;
+};
+
+#endif //VACUUM_FINAL_TOURPLANNER_H
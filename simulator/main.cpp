@@ -5,6 +5,9 @@
 #include <dlfcn.h>
 #include <fstream>
 #include <functional>
+#include <cstdint>
+#include <climits>
+#include <thread>
 #include "Simulation.h"
 #include "ConfigReader.h"
 #include "AlgorithmRegistrar.h"
@@ -21,25 +24,51 @@ std::string getArgValue(int argc, char* argv[], const std::string& arg) {
     return "";
 }
 
-void loadHouses(const std::string& housePath, std::vector<std::unique_ptr<House>>& houses, 
-                std::vector<int>& maxSteps, std::vector<int>& maxBatteries) {
+// Parse "first:last[:step]" or a single value into range; false if it is malformed or not positive
+bool parseSweepRange(const std::string& text, Simulation::SweepRange& range) {
+    try {
+        size_t firstEnd = text.find(':');
+        range.first = std::stoi(text.substr(0, firstEnd));
+        range.last = range.first;
+        range.step = 1;
+        if (firstEnd != std::string::npos) {
+            size_t lastEnd = text.find(':', firstEnd + 1);
+            range.last = std::stoi(text.substr(firstEnd + 1, lastEnd - firstEnd - 1));
+            if (lastEnd != std::string::npos) {
+                range.step = std::stoi(text.substr(lastEnd + 1));
+            }
+        }
+    } catch (const std::exception& e) {
+        return false;
+    }
+    return range.first > 0 && range.first <= range.last && range.step > 0;
+}
+
+// Hand each house to sim as soon as it is parsed, then close the houses; runSimulations may already be running
+void loadHouses(const std::string& housePath, Simulation& sim) {
     std::cout << "Loading houses from: " << housePath << std::endl;
-    for (const auto& entry : fs::directory_iterator(housePath)) {
-        if (entry.path().extension() == ".house") {
-            try {
-                ConfigReader config(entry.path().string());
-                houses.push_back(std::make_unique<House>(config.getLayout(), config.getHouseName()));
-                maxSteps.push_back(config.getMaxSteps());
-                maxBatteries.push_back(config.getMaxBattery());
-                std::cout << "Loaded house: " << config.getHouseName() << std::endl;
-            } catch (const std::exception& e) {
-                std::cerr << "Error loading house file " << entry.path() << ": " << e.what() << std::endl;
-                std::ofstream errorFile(entry.path().stem().string() + ".error");
-                errorFile << "Error loading house file: " << e.what() << std::endl;
+    size_t loaded = 0;
+    try {
+        for (const auto& entry : fs::directory_iterator(housePath)) {
+            if (entry.path().extension() == ".house") {
+                try {
+                    ConfigReader config(entry.path().string());
+                    sim.addHouse(std::make_unique<House>(config.getLayout(), config.getHouseName()),
+                                 config.getMaxSteps(), config.getMaxBattery());
+                    ++loaded;
+                    std::cout << "Loaded house: " << config.getHouseName() << std::endl;
+                } catch (const std::exception& e) {
+                    std::cerr << "Error loading house file " << entry.path() << ": " << e.what() << std::endl;
+                    std::ofstream errorFile(entry.path().stem().string() + ".error");
+                    errorFile << "Error loading house file: " << e.what() << std::endl;
+                }
             }
         }
+    } catch (const fs::filesystem_error& e) {
+        std::cerr << "Error reading house directory " << housePath << ": " << e.what() << std::endl;
     }
-    std::cout << "Total houses loaded: " << houses.size() << std::endl;
+    sim.closeHouses();
+    std::cout << "Total houses loaded: " << loaded << std::endl;
 }
 
 void loadAlgorithms(const std::string& algoPath, std::vector<void*>& handles, 
@@ -79,8 +108,18 @@ void cleanupAlgorithms(std::vector<void*>& handles) {
 int main(int argc, char* argv[]) {
     std::string housePath = getArgValue(argc, argv, "-house_path=");
     std::string algoPath = getArgValue(argc, argv, "-algo_path=");
-    int numThreads = 10;
+    int numThreads = Simulation::defaultThreadCount();
     bool summaryOnly = false;
+    bool memoryReport = false;
+    bool timingReport = false;
+    Simulation::TimeoutClock timeoutClock = Simulation::TimeoutClock::Wall;
+    int numProcesses = 0;
+    int variants = 0;
+    std::uint64_t seed = 1;
+    Simulation::PruneOptions pruning;
+    Simulation::PlacementOptions placement;
+    Simulation::SweepRange sweepBatteries;
+    Simulation::SweepRange sweepSteps;
 
     // Parse command-line arguments
     for (int i = 1; i < argc; ++i) {
@@ -94,6 +133,73 @@ int main(int argc, char* argv[]) {
             }
         } else if (arg == "-summary_only") {
             summaryOnly = true;
+        } else if (arg == "-pin_threads") {
+            placement.pinWorkers = true;
+        } else if (arg == "-numa_local") {
+            placement.localHouses = true;
+        } else if (arg.rfind("-processes=", 0) == 0) {
+            try {
+                numProcesses = std::stoi(arg.substr(11));
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid value for -processes. It must be a positive integer." << std::endl;
+                return 1;
+            }
+            if (numProcesses <= 0) {
+                std::cerr << "Error: -processes must be a positive integer." << std::endl;
+                return 1;
+            }
+        } else if (arg == "-memory_report") {
+            memoryReport = true;
+        } else if (arg == "-timing_report") {
+            timingReport = true;
+        } else if (arg.rfind("-timeout_clock=", 0) == 0) {
+            std::string clock = arg.substr(15);
+            if (clock == "wall") {
+                timeoutClock = Simulation::TimeoutClock::Wall;
+            } else if (clock == "cpu") {
+                timeoutClock = Simulation::TimeoutClock::Cpu;
+            } else {
+                std::cerr << "Error: -timeout_clock must be wall or cpu." << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind("-variants=", 0) == 0) {
+            try {
+                variants = std::stoi(arg.substr(10));
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid value for -variants. It must be a positive integer." << std::endl;
+                return 1;
+            }
+            if (variants <= 0) {
+                std::cerr << "Error: -variants must be a positive integer." << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind("-sweep_battery=", 0) == 0) {
+            if (!parseSweepRange(arg.substr(15), sweepBatteries)) {
+                std::cerr << "Error: -sweep_battery must be first:last[:step] with positive values." << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind("-sweep_steps=", 0) == 0) {
+            if (!parseSweepRange(arg.substr(13), sweepSteps)) {
+                std::cerr << "Error: -sweep_steps must be first:last[:step] with positive values." << std::endl;
+                return 1;
+            }
+        } else if (arg == "-prune") {
+            pruning.enabled = true;
+        } else if (arg.rfind("-prune_threshold=", 0) == 0) {
+            try {
+                pruning.threshold = std::stoi(arg.substr(17));
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid value for -prune_threshold. It must be an integer." << std::endl;
+                return 1;
+            }
+            pruning.enabled = true;
+        } else if (arg.rfind("-seed=", 0) == 0) {
+            try {
+                seed = std::stoull(arg.substr(6));
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid value for -seed. It must be a non-negative integer." << std::endl;
+                return 1;
+            }
         }
     }
 
@@ -115,39 +221,115 @@ int main(int argc, char* argv[]) {
     std::cout << "Algorithm path: " << algoPath << std::endl;
     std::cout << "Number of threads: " << numThreads << std::endl;
     std::cout << "Summary only: " << (summaryOnly ? "Yes" : "No") << std::endl;
+    std::cout << "Timeout clock: " << (timeoutClock == Simulation::TimeoutClock::Cpu ? "thread CPU time" : "wall time")
+              << std::endl;
+    if (placement.pinWorkers || placement.localHouses) {
+        std::cout << "Worker placement:" << (placement.pinWorkers ? " pinned" : "")
+                  << (placement.localHouses ? " node-local houses" : "") << std::endl;
+    }
+    if (pruning.enabled) {
+        std::cout << "Pruning: on";
+        if (pruning.threshold != INT_MAX) {
+            std::cout << ", threshold " << pruning.threshold;
+        }
+        std::cout << std::endl;
+    }
+    bool sweep = sweepBatteries.isSet() || sweepSteps.isSet();
+    if (sweep && variants > 0) {
+        std::cerr << "Error: -variants cannot be combined with -sweep_battery or -sweep_steps." << std::endl;
+        return 1;
+    }
+    if (numProcesses > 0 && (sweep || variants > 0)) {
+        std::cerr << "Error: -processes cannot be combined with -variants, -sweep_battery or -sweep_steps." << std::endl;
+        return 1;
+    }
+    if ((memoryReport || timingReport) && (sweep || variants > 0)) {
+        std::cerr << "Error: -memory_report and -timing_report cannot be combined with -variants, -sweep_battery or "
+                     "-sweep_steps." << std::endl;
+        return 1;
+    }
+    if (numProcesses > 0) {
+        std::cout << "Worker processes: " << numProcesses << std::endl;
+    }
+    if (sweep) {
+        auto describe = [](const Simulation::SweepRange& range) {
+            return range.isSet() ? std::to_string(range.first) + ".." + std::to_string(range.last) +
+                                   " step " + std::to_string(range.step)
+                                 : std::string("from house files");
+        };
+        std::cout << "Sweep: MaxBattery " << describe(sweepBatteries) << ", MaxSteps " << describe(sweepSteps)
+                  << std::endl;
+    }
+    if (variants > 0) {
+        std::cout << "Dirt variants: " << variants << " per house, seed " << seed << std::endl;
+    }
 
-    // Load houses
- std::vector<std::unique_ptr<House>> houses;
-    std::vector<int> maxSteps;
-    std::vector<int> maxBatteries;
-    loadHouses(housePath, houses, maxSteps, maxBatteries);
-
-    // Load algorithms
-    
+    // Load algorithms first: every run needs all of them, while houses can be run one by one as they load
     std::vector<void*> algoHandles;
     std::vector<std::pair<std::string, std::function<std::unique_ptr<AbstractAlgorithm>()>>> algorithms;
     std::cout << "Current working directory: " << std::filesystem::current_path() << std::endl;
-    std::cout << "Contents of algorithm directory:" << std::endl;for (const auto& entry : std::filesystem::directory_iterator(algoPath)) {
-    std::cout << entry.path() << std::endl;
-}
     loadAlgorithms(algoPath, algoHandles, algorithms);
 
-    if (houses.empty() || algorithms.empty()) {
-        std::cerr << "Error: No houses or algorithms loaded. Exiting." << std::endl;
+    if (algorithms.empty()) {
+        std::cerr << "Error: No algorithms loaded. Exiting." << std::endl;
         cleanupAlgorithms(algoHandles);
         return 1;
     }
 
     // Create and run simulation
     std::cout << "Creating simulation..." << std::endl;
-    Simulation sim(std::move(houses), std::move(maxSteps), std::move(maxBatteries));
+    Simulation sim;
+    sim.setPruning(pruning);
+    sim.setPlacement(placement);
+    sim.setTimeoutClock(timeoutClock);
+
+    // Plain runs start on the first houses while the rest are still being read; the other modes need all of them
+    bool streaming = !sweep && variants == 0 && numProcesses == 0;
+    std::thread houseLoader;
+    if (streaming) {
+        houseLoader = std::thread([&housePath, &sim] { loadHouses(housePath, sim); });
+    } else {
+        loadHouses(housePath, sim);
+        if (sim.houseCount() == 0) {
+            std::cerr << "Error: No houses loaded. Exiting." << std::endl;
+            cleanupAlgorithms(algoHandles);
+            return 1;
+        }
+    }
     std::cout << "Running simulations..." << std::endl;
-    sim.runSimulations(algorithms, numThreads, summaryOnly);
-    
+    if (sweep) {
+        sim.runSweep(algorithms, numThreads, sweepBatteries, sweepSteps);
+        std::cout << "Generating sweep report..." << std::endl;
+        sim.generateSweepReport();
+    } else if (variants > 0) {
+        sim.runVariants(algorithms, numThreads, variants, seed);
+        std::cout << "Generating variant report..." << std::endl;
+        sim.generateVariantReport();
+    } else {
+        if (numProcesses > 0) {
+            sim.runSimulationsInProcesses(algorithms, numProcesses, summaryOnly);
+        } else {
+            sim.runSimulations(algorithms, numThreads, summaryOnly);
+            houseLoader.join();
+            if (sim.houseCount() == 0) {
+                std::cerr << "Error: No houses loaded. Exiting." << std::endl;
+                cleanupAlgorithms(algoHandles);
+                return 1;
+            }
+        }
 
-    if (!summaryOnly) {
-        std::cout << "Generating summary..." << std::endl;
-        sim.generateSummary();
+        if (!summaryOnly) {
+            std::cout << "Generating summary..." << std::endl;
+            sim.generateSummary();
+        }
+        if (memoryReport) {
+            std::cout << "Generating memory report..." << std::endl;
+            sim.generateMemoryReport();
+        }
+        if (timingReport) {
+            std::cout << "Generating timing report..." << std::endl;
+            sim.generateTimingReport();
+        }
     }
     std::cout << "Summary generated. Beginning cleanup..." << std::endl;
 
@@ -0,0 +1,99 @@
+// Scores saved step traces again without running any algorithm, e.g. after a change to the scoring or to the
+// output format. Reads the houses like main does and the <house>-<algo>.txt files of a previous run.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <chrono>
+#include <algorithm>
+#include "Simulation.h"
+#include "ConfigReader.h"
+
+namespace fs = std::filesystem;
+
+std::string getArgValue(int argc, char* argv[], const std::string& arg) {
+    for (int i = 1; i < argc; ++i) {
+        std::string argStr = argv[i];
+        if (argStr.find(arg) == 0) {
+            return argStr.substr(arg.length());
+        }
+    }
+    return "";
+}
+
+void loadHouses(const std::string& housePath, std::vector<std::unique_ptr<House>>& houses,
+                std::vector<int>& maxSteps, std::vector<int>& maxBatteries) {
+    for (const auto& entry : fs::directory_iterator(housePath)) {
+        if (entry.path().extension() == ".house") {
+            try {
+                ConfigReader config(entry.path().string());
+                houses.push_back(std::make_unique<House>(config.getLayout(), config.getHouseName()));
+                maxSteps.push_back(config.getMaxSteps());
+                maxBatteries.push_back(config.getMaxBattery());
+            } catch (const std::exception& e) {
+                std::cerr << "Error loading house file " << entry.path() << ": " << e.what() << std::endl;
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string housePath = getArgValue(argc, argv, "-house_path=");
+    std::string tracePath = getArgValue(argc, argv, "-trace_path=");
+    int numThreads = Simulation::defaultThreadCount();
+    bool quiet = false;
+    bool rewrite = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        if (arg.rfind("-num_threads=", 0) == 0) {
+            try {
+                numThreads = std::stoi(arg.substr(13));
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid value for -num_threads. It must be a positive integer." << std::endl;
+                return 1;
+            }
+        } else if (arg == "-quiet") {
+            quiet = true;
+        } else if (arg == "-rewrite") {
+            rewrite = true;
+        }
+    }
+
+    if (housePath.empty()) {
+        std::cerr << "Error: -house_path must be provided." << std::endl;
+        return 1;
+    }
+    if (tracePath.empty()) {
+        tracePath = ".";
+    }
+    if (numThreads <= 0) {
+        std::cerr << "Error: -num_threads must be a positive integer." << std::endl;
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<House>> houses;
+    std::vector<int> maxSteps;
+    std::vector<int> maxBatteries;
+    loadHouses(housePath, houses, maxSteps, maxBatteries);
+    if (houses.empty()) {
+        std::cerr << "Error: No houses loaded. Exiting." << std::endl;
+        return 1;
+    }
+
+    Simulation sim(std::move(houses), std::move(maxSteps), std::move(maxBatteries));
+    sim.setQuiet(quiet);
+    auto start = std::chrono::steady_clock::now();
+    Simulation::ReplayStats stats = sim.replayTraces(tracePath, numThreads, rewrite);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (stats.traces == 0) {
+        std::cerr << "Error: No step traces found in " << tracePath << "." << std::endl;
+        return 1;
+    }
+    sim.generateSummary();
+
+    std::cout << "Replayed " << stats.traces << " traces, " << stats.steps << " steps in " << elapsed.count()
+              << " s (" << static_cast<double>(stats.steps) / std::max(elapsed.count(), 1e-9) << " steps/s); "
+              << stats.changed << " differ from their stored result" << std::endl;
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Compares BitBfs with a plain queue-based BFS on random grids of many shapes and wall densities,
+// including widths that are not a multiple of the word size and grids wider than one AVX2 block. DistanceSearch
+// is run a few cells at a time to check that a search resumes where it stopped.
+#include <iostream>
+#include <queue>
+#include <random>
+#include <vector>
+#include "BitBfs.h"
+
+namespace {
+std::vector<int> plainDistances(const BitGrid& passable, Position src) {
+    int rows = passable.getRows();
+    int cols = passable.getCols();
+    std::vector<int> distances(static_cast<std::size_t>(rows) * cols, -1);
+    if (!passable.test(src.r, src.c)) {
+        return distances;
+    }
+    std::queue<Position> queue;
+    distances[static_cast<std::size_t>(src.r) * cols + src.c] = 0;
+    queue.push(src);
+    const Position offsets[4] = {{-1, 0}, {1, 0}, {0, 1}, {0, -1}};
+    while (!queue.empty()) {
+        Position pos = queue.front();
+        queue.pop();
+        int distance = distances[static_cast<std::size_t>(pos.r) * cols + pos.c];
+        for (const auto& offset : offsets) {
+            Position next = {pos.r + offset.r, pos.c + offset.c};
+            if (next.r < 0 || next.r >= rows || next.c < 0 || next.c >= cols || !passable.test(next.r, next.c)) {
+                continue;
+            }
+            int& seen = distances[static_cast<std::size_t>(next.r) * cols + next.c];
+            if (seen < 0) {
+                seen = distance + 1;
+                queue.push(next);
+            }
+        }
+    }
+    return distances;
+}
+}
+
+int main() {
+    std::mt19937 rng(2024);
+    const int shapes[][2] = {{1, 1}, {1, 70}, {70, 1}, {5, 63}, {9, 64}, {17, 65}, {33, 130}, {64, 64},
+                             {40, 257}, {100, 100}, {3, 600}, {250, 31}};
+    const double densities[] = {0.0, 0.1, 0.3, 0.45, 0.6};
+    int grids = 0;
+    int failures = 0;
+    for (const auto& shape : shapes) {
+        for (double density : densities) {
+            for (int round = 0; round < 4; ++round) {
+                int rows = shape[0];
+                int cols = shape[1];
+                BitGrid passable(rows, cols);
+                std::bernoulli_distribution wall(density);
+                for (int r = 0; r < rows; ++r) {
+                    for (int c = 0; c < cols; ++c) {
+                        passable.set(r, c, !wall(rng));
+                    }
+                }
+                Position src = {static_cast<int>(rng() % rows), static_cast<int>(rng() % cols)};
+                passable.set(src.r, src.c);
+
+                std::vector<int> expected = plainDistances(passable, src);
+                std::vector<int> distances = BitBfs::distanceField(passable, src);
+                BitGrid reached = BitBfs::reachable(passable, src);
+                DistanceSearch search(passable, src);
+                while (!search.expand(7)) {
+                }
+                bool same = distances == expected && search.takeDistances() == expected;
+                for (int r = 0; r < rows && same; ++r) {
+                    for (int c = 0; c < cols && same; ++c) {
+                        same = reached.test(r, c) == (expected[static_cast<std::size_t>(r) * cols + c] >= 0);
+                    }
+                }
+                ++grids;
+                if (!same) {
+                    ++failures;
+                    std::cerr << "Mismatch on a " << rows << "x" << cols << " grid with wall density " << density
+                              << ", source (" << src.r << "," << src.c << ")" << std::endl;
+                }
+            }
+        }
+    }
+    std::cout << grids - failures << " of " << grids << " grids match the plain BFS" << std::endl;
+    return failures == 0 ? 0 : 1;
+}